@@ -0,0 +1,208 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+#include "bst.h"
+#include "levenshtein.h"
+#include "suggest.h"
+
+// Roster-scale benchmark for the access-check hot path.
+// Usage: ./AccessControlBench [max_names] [seed]
+// Rosters grow by 10x from 1e2 up to max_names (default 1e6, up to 1e7).
+
+#define NAME_LEN 50
+#define LOOKUP_QUERIES 100000
+#define SUGGEST_BUDGET 2000000.0 // Levenshtein calls allowed per roster size
+
+static const char* firstNames[] = {
+    "John", "Jane", "Alice", "Bob", "Carol", "David", "Emma", "Frank", "Grace", "Henry",
+    "Isabel", "James", "Karen", "Lungile", "Michael", "Nadia", "Oscar", "Paula", "Quinn", "Robert",
+    "Sarah", "Thomas", "Uma", "Victor", "Wendy", "Xavier", "Yara", "Zanele", "Thabo", "Amara"
+};
+static const char* lastNames[] = {
+    "Smith", "Doe", "Johnson", "Wilson", "Brown", "Adams", "Mabe", "Taylor", "Moore", "Clark",
+    "Lewis", "Walker", "Hall", "Young", "King", "Wright", "Green", "Baker", "Nelson", "Carter",
+    "Mitchell", "Perez", "Roberts", "Turner", "Phillips", "Campbell", "Parker", "Evans", "Nkosi", "Dlamini"
+};
+#define FIRST_COUNT (sizeof(firstNames) / sizeof(firstNames[0]))
+#define LAST_COUNT (sizeof(lastNames) / sizeof(lastNames[0]))
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int compareDoubles(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Build the i-th unique roster name: "<First> <Last> <base-26 tag>"
+static void makeName(char* out, size_t i) {
+    char tag[16];
+    int len = 0;
+    size_t rest = i / (FIRST_COUNT * LAST_COUNT);
+    do {
+        tag[len++] = 'a' + (char)(rest % 26);
+        rest /= 26;
+    } while (rest > 0);
+    tag[len] = '\0';
+    snprintf(out, NAME_LEN, "%s %s %s",
+             firstNames[i % FIRST_COUNT], lastNames[(i / FIRST_COUNT) % LAST_COUNT], tag);
+}
+
+// Apply a single typo: substitution, deletion, insertion or adjacent transposition
+static void applyEdit(char* s) {
+    int len = (int)strlen(s);
+    if (len < 2) return;
+    int pos = rand() % len;
+    char letter = 'a' + rand() % 26;
+
+    switch (rand() % 4) {
+    case 0: // Substitution
+        s[pos] = letter;
+        break;
+    case 1: // Deletion
+        memmove(s + pos, s + pos + 1, len - pos);
+        break;
+    case 2: // Insertion
+        if (len + 1 < NAME_LEN) {
+            memmove(s + pos + 1, s + pos, len - pos + 1);
+            s[pos] = letter;
+        }
+        break;
+    default: // Transposition
+        if (pos + 1 < len) {
+            char tmp = s[pos];
+            s[pos] = s[pos + 1];
+            s[pos + 1] = tmp;
+        }
+        break;
+    }
+}
+
+// Typo distribution: 70% one edit, 25% two edits, 5% three edits
+static void makeTypo(char* out, const char* name) {
+    int roll = rand() % 100;
+    int edits = (roll < 70) ? 1 : (roll < 95) ? 2 : 3;
+    strcpy(out, name);
+    for (int e = 0; e < edits; e++) {
+        applyEdit(out);
+    }
+}
+
+static size_t treeBytes(NameNode* node) {
+    if (node == NULL) return 0;
+    return sizeof(NameNode) + strlen(node->name) + 1 + treeBytes(node->left) + treeBytes(node->right);
+}
+
+static long peakRssKb(void) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+static void runRoster(size_t n) {
+    char (*roster)[NAME_LEN] = malloc(n * sizeof(*roster));
+    if (roster == NULL) {
+        fprintf(stderr, "Could not allocate roster of %zu names\n", n);
+        return;
+    }
+    for (size_t i = 0; i < n; i++) {
+        makeName(roster[i], i);
+    }
+    // Shuffle so the AVL tree sees insertions in random order
+    for (size_t i = n - 1; i > 0; i--) {
+        size_t j = ((size_t)rand() * RAND_MAX + rand()) % (i + 1);
+        char tmp[NAME_LEN];
+        memcpy(tmp, roster[i], NAME_LEN);
+        memcpy(roster[i], roster[j], NAME_LEN);
+        memcpy(roster[j], tmp, NAME_LEN);
+    }
+
+    // Load
+    NameNode* root = NULL;
+    double start = nowSeconds();
+    for (size_t i = 0; i < n; i++) {
+        root = insertName(root, roster[i]);
+    }
+    double loadTime = nowSeconds() - start;
+
+    // Exact hits
+    volatile int sink = 0;
+    start = nowSeconds();
+    for (int q = 0; q < LOOKUP_QUERIES; q++) {
+        sink += searchName(root, roster[((size_t)rand() * RAND_MAX + rand()) % n]);
+    }
+    double hitNs = (nowSeconds() - start) / LOOKUP_QUERIES * 1e9;
+
+    // Misses (typos of authorized names)
+    char (*typos)[NAME_LEN] = malloc(LOOKUP_QUERIES * sizeof(*typos));
+    if (typos == NULL) {
+        fprintf(stderr, "Could not allocate %d typo queries\n", LOOKUP_QUERIES);
+        free(roster);
+        freeTree(root);
+        return;
+    }
+    for (int q = 0; q < LOOKUP_QUERIES; q++) {
+        makeTypo(typos[q], roster[((size_t)rand() * RAND_MAX + rand()) % n]);
+    }
+    start = nowSeconds();
+    for (int q = 0; q < LOOKUP_QUERIES; q++) {
+        sink += searchName(root, typos[q]);
+    }
+    double missNs = (nowSeconds() - start) / LOOKUP_QUERIES * 1e9;
+
+    // Suggestions scan the whole roster, so scale the query count down with n
+    int suggestQueries = (int)(SUGGEST_BUDGET / n);
+    if (suggestQueries > 1000) suggestQueries = 1000;
+    if (suggestQueries < 5) suggestQueries = 5;
+    double* latencies = malloc(suggestQueries * sizeof(double));
+    if (latencies == NULL) {
+        fprintf(stderr, "Could not allocate %d suggestion latencies\n", suggestQueries);
+        free(typos);
+        free(roster);
+        freeTree(root);
+        return;
+    }
+    char closest[NAME_LEN];
+    for (int q = 0; q < suggestQueries; q++) {
+        start = nowSeconds();
+        sink += findClosestName(root, typos[q], closest, sizeof(closest));
+        latencies[q] = (nowSeconds() - start) * 1e3;
+    }
+    qsort(latencies, suggestQueries, sizeof(double), compareDoubles);
+
+    printf("%10zu %10.3f %9.1f %9.1f %10.3f %10.3f %10.3f %10.3f %12.1f %10ld\n",
+           n, loadTime * 1e3, hitNs, missNs,
+           latencies[suggestQueries / 2],
+           latencies[(int)(suggestQueries * 0.90)],
+           latencies[(int)(suggestQueries * 0.99)],
+           latencies[suggestQueries - 1],
+           treeBytes(root) / 1048576.0, peakRssKb());
+    fflush(stdout);
+
+    (void)sink;
+    free(latencies);
+    free(typos);
+    free(roster);
+    freeTree(root);
+}
+
+int main(int argc, char* argv[]) {
+    size_t maxNames = (argc > 1) ? strtoul(argv[1], NULL, 10) : 1000000;
+    unsigned seed = (argc > 2) ? (unsigned)strtoul(argv[2], NULL, 10) : 42;
+    srand(seed);
+
+    printf("# load=ms hit/miss=ns/lookup suggest=ms (p50/p90/p99/max) tree=MiB rss=KiB\n");
+    printf("%10s %10s %9s %9s %10s %10s %10s %10s %12s %10s\n",
+           "names", "load", "hit", "miss", "sugg_p50", "sugg_p90", "sugg_p99", "sugg_max", "tree_mib", "rss_kib");
+    for (size_t n = 100; n <= maxNames; n *= 10) {
+        runRoster(n);
+    }
+    return 0;
+}
@@ -2,7 +2,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "bst.h"
-#include "levenshtein.h"
+#include "suggest.h"
 
 #define MAX_NAMES 40
 #define LOG_FILE "unrecognized_names.log"
@@ -38,30 +38,6 @@ void logUnrecognized(const char* name) {
     }
 }
 
-void findClosest(NameNode* node, const char* inputName, int* minDistance, char* closestName, int* found) {
-    if (node == NULL) return;
-    int distance = levenshteinDistance(node->name, inputName);
-    if (distance < *minDistance) {
-        *minDistance = distance;
-        strcpy(closestName, node->name);
-        *found = 1;
-    }
-    findClosest(node->left, inputName, minDistance, closestName, found);
-    findClosest(node->right, inputName, minDistance, closestName, found);
-}
-
-void suggestSimilarNames(NameNode* root, const char* inputName) {
-    int minDistance = 100; // Arbitrarily large distance
-    char closestName[50];
-    int found = 0;
-
-    findClosest(root, inputName, &minDistance, closestName, &found);
-
-    if (found) {
-        printf("Did you mean: %s?\n", closestName);
-    }
-}
-
 int main() {
     NameNode* root = NULL;
     loadNames(&root);
@@ -0,0 +1,37 @@
+#include <stdio.h>
+#include <string.h>
+#include "suggest.h"
+#include "levenshtein.h"
+
+// Walk the whole tree keeping the node with the smallest distance so far
+static void findClosest(NameNode* node, const char* inputName, int* minDistance, const char** closestName) {
+    if (node == NULL) return;
+    int distance = levenshteinDistance(node->name, inputName);
+    if (*minDistance < 0 || distance < *minDistance) {
+        *minDistance = distance;
+        *closestName = node->name;
+    }
+    findClosest(node->left, inputName, minDistance, closestName);
+    findClosest(node->right, inputName, minDistance, closestName);
+}
+
+int findClosestName(NameNode* root, const char* inputName, char* closestName, size_t size) {
+    int minDistance = -1;
+    const char* closest = NULL;
+
+    findClosest(root, inputName, &minDistance, &closest);
+
+    if (closest != NULL && size > 0) {
+        strncpy(closestName, closest, size - 1);
+        closestName[size - 1] = '\0';
+    }
+    return minDistance;
+}
+
+void suggestSimilarNames(NameNode* root, const char* inputName) {
+    char closestName[50];
+
+    if (findClosestName(root, inputName, closestName, sizeof(closestName)) >= 0) {
+        printf("Did you mean: %s?\n", closestName);
+    }
+}
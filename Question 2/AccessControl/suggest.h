@@ -0,0 +1,15 @@
+#ifndef SUGGEST_H
+#define SUGGEST_H
+
+#include <stddef.h>
+#include "name_node.h"
+
+// Find the authorized name closest to inputName by Levenshtein distance.
+// Copies it into closestName (at most size bytes) and returns the distance,
+// or -1 if the tree is empty.
+int findClosestName(NameNode* root, const char* inputName, char* closestName, size_t size);
+
+// Print a "Did you mean" hint for the closest authorized name
+void suggestSimilarNames(NameNode* root, const char* inputName);
+
+#endif // SUGGEST_H
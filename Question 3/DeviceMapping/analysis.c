@@ -0,0 +1,441 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "analysis.h"
+
+#define BFS_CHUNK 256 // Frontier entries or devices claimed per grab, and batch size
+#define BFS_ALPHA 14  // Go bottom-up once frontier edges exceed unexplored edges / alpha
+#define BFS_BETA 24   // Go back top-down once the frontier drops below devices / beta
+
+// ---- Direction-optimizing parallel BFS ----
+
+typedef struct {
+    const Graph* graph;
+    unsigned char* visited;          // Devices reached so far
+    const unsigned char* inFrontier; // Bottom-up: membership of the current frontier
+    int blocked;                     // Device the search may not enter
+    const int* frontier;             // Current frontier
+    int frontierSize;
+    int* next;                       // Next frontier, filled by all workers
+    int nextSize;                    // Atomic
+    int cursor;                      // Atomic work-claim position
+    long long nextEdges;             // Atomic: out-degree sum of the next frontier
+} BfsStep;
+
+static void flushBatch(BfsStep* step, const int* batch, int count, long long edges) {
+    if (count == 0) return;
+    int at = __atomic_fetch_add(&step->nextSize, count, __ATOMIC_RELAXED);
+    memcpy(step->next + at, batch, count * sizeof(int));
+    __atomic_fetch_add(&step->nextEdges, edges, __ATOMIC_RELAXED);
+}
+
+// Expand frontier devices outward, claiming each target with an atomic exchange
+static void topDownTask(void* context, int worker, int workers) {
+    BfsStep* step = (BfsStep*)context;
+    int batch[BFS_CHUNK];
+    int count = 0;
+    long long edges = 0;
+    (void)worker;
+    (void)workers;
+
+    for (;;) {
+        int start = __atomic_fetch_add(&step->cursor, BFS_CHUNK, __ATOMIC_RELAXED);
+        if (start >= step->frontierSize) break;
+        int end = (start + BFS_CHUNK < step->frontierSize) ? start + BFS_CHUNK : step->frontierSize;
+        for (int i = start; i < end; i++) {
+            NeighborIterator it;
+            beginOutNeighbors(step->graph, step->frontier[i], &it);
+            for (int w = nextNeighbor(&it); w != -1; w = nextNeighbor(&it)) {
+                if (w == step->blocked || __atomic_load_n(&step->visited[w], __ATOMIC_RELAXED)) continue;
+                if (__atomic_exchange_n(&step->visited[w], 1, __ATOMIC_RELAXED) == 0) {
+                    batch[count++] = w;
+                    edges += outDegree(step->graph, w);
+                    if (count == BFS_CHUNK) {
+                        flushBatch(step, batch, count, edges);
+                        count = 0;
+                        edges = 0;
+                    }
+                }
+            }
+        }
+    }
+    flushBatch(step, batch, count, edges);
+}
+
+// Let every unvisited device look for a parent in the frontier; each device has one owner
+static void bottomUpTask(void* context, int worker, int workers) {
+    BfsStep* step = (BfsStep*)context;
+    int deviceCount = step->graph->deviceCount;
+    int batch[BFS_CHUNK];
+    int count = 0;
+    long long edges = 0;
+    (void)worker;
+    (void)workers;
+
+    for (;;) {
+        int start = __atomic_fetch_add(&step->cursor, BFS_CHUNK, __ATOMIC_RELAXED);
+        if (start >= deviceCount) break;
+        int end = (start + BFS_CHUNK < deviceCount) ? start + BFS_CHUNK : deviceCount;
+        for (int v = start; v < end; v++) {
+            if (step->visited[v] || v == step->blocked) continue;
+            NeighborIterator it;
+            beginInNeighbors(step->graph, v, &it);
+            for (int u = nextNeighbor(&it); u != -1; u = nextNeighbor(&it)) {
+                if (step->inFrontier[u]) {
+                    step->visited[v] = 1;
+                    batch[count++] = v;
+                    edges += outDegree(step->graph, v);
+                    break;
+                }
+            }
+            if (count == BFS_CHUNK) {
+                flushBatch(step, batch, count, edges);
+                count = 0;
+                edges = 0;
+            }
+        }
+    }
+    flushBatch(step, batch, count, edges);
+}
+
+int reachableFrom(const Graph* graph, ThreadPool* pool, int source, int blocked, unsigned char* reached) {
+    int n = graph->deviceCount;
+    memset(reached, 0, (size_t)n);
+    if (source < 0 || source >= n || source == blocked) {
+        return 0;
+    }
+
+    int* frontier = (int*)malloc(n * sizeof(int));
+    int* next = (int*)malloc(n * sizeof(int));
+    unsigned char* inFrontier = (unsigned char*)calloc(n, 1);
+    if (frontier == NULL || next == NULL || inFrontier == NULL) {
+        free(frontier);
+        free(next);
+        free(inFrontier);
+        return -1;
+    }
+
+    reached[source] = 1;
+    frontier[0] = source;
+    int frontierSize = 1;
+    int total = 1;
+    long long frontierEdges = outDegree(graph, source);
+    long long unexplored = graph->edgeCount - frontierEdges;
+    int bottomUp = 0;
+
+    while (frontierSize > 0) {
+        if (!bottomUp && frontierEdges > unexplored / BFS_ALPHA) {
+            bottomUp = 1;
+        } else if (bottomUp && frontierSize < n / BFS_BETA) {
+            bottomUp = 0;
+        }
+
+        BfsStep step = { graph, reached, inFrontier, blocked, frontier, frontierSize, next, 0, 0, 0 };
+        if (bottomUp) {
+            for (int i = 0; i < frontierSize; i++) inFrontier[frontier[i]] = 1;
+            threadPoolRun(pool, bottomUpTask, &step);
+            for (int i = 0; i < frontierSize; i++) inFrontier[frontier[i]] = 0;
+        } else {
+            threadPoolRun(pool, topDownTask, &step);
+        }
+
+        int* swap = frontier;
+        frontier = next;
+        next = swap;
+        frontierSize = step.nextSize;
+        total += frontierSize;
+        frontierEdges = step.nextEdges;
+        unexplored -= frontierEdges;
+    }
+
+    free(frontier);
+    free(next);
+    free(inFrontier);
+    return total;
+}
+
+int failureImpact(const Graph* graph, ThreadPool* pool, int gateway, int failed, int* lost) {
+    int n = graph->deviceCount;
+    unsigned char* before = (unsigned char*)malloc(n + 1);
+    unsigned char* after = (unsigned char*)malloc(n + 1);
+    int count = -1;
+    if (before != NULL && after != NULL &&
+        reachableFrom(graph, pool, gateway, -1, before) >= 0 &&
+        reachableFrom(graph, pool, gateway, failed, after) >= 0) {
+        count = 0;
+        for (int v = 0; v < n; v++) {
+            if (before[v] && !after[v] && v != failed) {
+                lost[count++] = v;
+            }
+        }
+    }
+    free(before);
+    free(after);
+    return count;
+}
+
+// ---- Strongly connected components (iterative Tarjan) ----
+
+typedef struct {
+    int device;
+    NeighborIterator it;
+} SccFrame;
+
+int stronglyConnectedComponents(const Graph* graph, int* component) {
+    int n = graph->deviceCount;
+    int* index = (int*)malloc((n + 1) * sizeof(int));
+    int* low = (int*)malloc((n + 1) * sizeof(int));
+    int* stack = (int*)malloc((n + 1) * sizeof(int));
+    unsigned char* onStack = (unsigned char*)calloc(n + 1, 1);
+    SccFrame* frames = (SccFrame*)malloc((n + 1) * sizeof(SccFrame));
+    if (index == NULL || low == NULL || stack == NULL || onStack == NULL || frames == NULL) {
+        free(index);
+        free(low);
+        free(stack);
+        free(onStack);
+        free(frames);
+        return -1;
+    }
+    for (int v = 0; v < n; v++) index[v] = -1;
+
+    int counter = 0;
+    int components = 0;
+    int top = 0;
+    for (int root = 0; root < n; root++) {
+        if (index[root] != -1) continue;
+
+        int depth = 0;
+        index[root] = low[root] = counter++;
+        stack[top++] = root;
+        onStack[root] = 1;
+        frames[depth].device = root;
+        beginOutNeighbors(graph, root, &frames[depth].it);
+        depth++;
+
+        while (depth > 0) {
+            SccFrame* frame = &frames[depth - 1];
+            int v = frame->device;
+            int w = nextNeighbor(&frame->it);
+            if (w != -1) {
+                if (index[w] == -1) {
+                    index[w] = low[w] = counter++;
+                    stack[top++] = w;
+                    onStack[w] = 1;
+                    frames[depth].device = w;
+                    beginOutNeighbors(graph, w, &frames[depth].it);
+                    depth++;
+                } else if (onStack[w] && index[w] < low[v]) {
+                    low[v] = index[w];
+                }
+                continue;
+            }
+
+            // v is finished: pop its component if it is the root of one
+            if (low[v] == index[v]) {
+                int x;
+                do {
+                    x = stack[--top];
+                    onStack[x] = 0;
+                    component[x] = components;
+                } while (x != v);
+                components++;
+            }
+            depth--;
+            if (depth > 0) {
+                int parent = frames[depth - 1].device;
+                if (low[v] < low[parent]) low[parent] = low[v];
+            }
+        }
+    }
+
+    free(index);
+    free(low);
+    free(stack);
+    free(onStack);
+    free(frames);
+    return components;
+}
+
+// ---- Articulation points and bridges (iterative DFS, links taken as undirected) ----
+
+typedef struct {
+    int device;
+    int parent;
+    int children;
+    int incoming;        // 0 while walking outgoing links, 1 for incoming
+    NeighborIterator it;
+} CutFrame;
+
+// Next neighbor in the undirected view: outgoing links, then incoming ones
+static int nextLink(const Graph* graph, CutFrame* frame) {
+    for (;;) {
+        int w = nextNeighbor(&frame->it);
+        if (w != -1 || frame->incoming) return w;
+        frame->incoming = 1;
+        beginInNeighbors(graph, frame->device, &frame->it);
+    }
+}
+
+static void pushCutFrame(const Graph* graph, CutFrame* frame, int device, int parent) {
+    frame->device = device;
+    frame->parent = parent;
+    frame->children = 0;
+    frame->incoming = 0;
+    beginOutNeighbors(graph, device, &frame->it);
+}
+
+int findCriticalLinks(const Graph* graph, unsigned char* isArticulation, int* bridges, int* bridgeCount) {
+    int n = graph->deviceCount;
+    int* disc = (int*)malloc((n + 1) * sizeof(int));
+    int* low = (int*)malloc((n + 1) * sizeof(int));
+    CutFrame* frames = (CutFrame*)malloc((n + 1) * sizeof(CutFrame));
+    if (disc == NULL || low == NULL || frames == NULL) {
+        free(disc);
+        free(low);
+        free(frames);
+        return -1;
+    }
+    for (int v = 0; v < n; v++) {
+        disc[v] = -1;
+        isArticulation[v] = 0;
+    }
+
+    int counter = 0;
+    int articulations = 0;
+    int bridgesFound = 0;
+    for (int root = 0; root < n; root++) {
+        if (disc[root] != -1) continue;
+
+        int depth = 0;
+        disc[root] = low[root] = counter++;
+        pushCutFrame(graph, &frames[depth++], root, -1);
+
+        while (depth > 0) {
+            CutFrame* frame = &frames[depth - 1];
+            int v = frame->device;
+            int w = nextLink(graph, frame);
+            if (w != -1) {
+                if (w == frame->parent || w == v) continue; // Same link back, or a self-loop
+                if (disc[w] == -1) {
+                    frame->children++;
+                    disc[w] = low[w] = counter++;
+                    pushCutFrame(graph, &frames[depth++], w, v);
+                } else if (disc[w] < low[v]) {
+                    low[v] = disc[w];
+                }
+                continue;
+            }
+
+            depth--;
+            if (depth == 0) {
+                if (frame->children > 1 && !isArticulation[v]) {
+                    isArticulation[v] = 1;
+                    articulations++;
+                }
+                break;
+            }
+            int p = frames[depth - 1].device;
+            if (low[v] < low[p]) low[p] = low[v];
+            if (low[v] >= disc[p] && frames[depth - 1].parent != -1 && !isArticulation[p]) {
+                isArticulation[p] = 1;
+                articulations++;
+            }
+            if (low[v] > disc[p]) {
+                if (bridges != NULL) {
+                    bridges[2 * bridgesFound] = p;
+                    bridges[2 * bridgesFound + 1] = v;
+                }
+                bridgesFound++;
+            }
+        }
+    }
+
+    if (bridgeCount != NULL) *bridgeCount = bridgesFound;
+    free(disc);
+    free(low);
+    free(frames);
+    return articulations;
+}
+
+// ---- Reports ----
+
+void displayFailureImpact(Graph* graph, ThreadPool* pool, const char* gatewayID, const char* failedID) {
+    int gateway = findDevice(graph, gatewayID);
+    int failed = findDevice(graph, failedID);
+    if (gateway == -1 || failed == -1) {
+        printf("Invalid device ID(s).\n");
+        return;
+    }
+    int* lost = (int*)malloc((graph->deviceCount + 1) * sizeof(int));
+    int count = (lost != NULL) ? failureImpact(graph, pool, gateway, failed, lost) : -1;
+    if (count < 0) {
+        printf("Out of memory during analysis.\n");
+    } else if (count == 0) {
+        printf("No device loses its path from %s if %s fails.\n", gatewayID, failedID);
+    } else {
+        printf("If %s fails, %d device(s) lose their path from %s:\n", failedID, count, gatewayID);
+        for (int i = 0; i < count; i++) {
+            printf("- %s\n", deviceName(graph, lost[i]));
+        }
+    }
+    free(lost);
+}
+
+void displayStronglyConnectedComponents(Graph* graph) {
+    int n = graph->deviceCount;
+    int* component = (int*)malloc((n + 1) * sizeof(int));
+    int count = (component != NULL) ? stronglyConnectedComponents(graph, component) : -1;
+    if (count < 0) {
+        printf("Out of memory during analysis.\n");
+        free(component);
+        return;
+    }
+    printf("Strongly connected components: %d\n", count);
+
+    // Bucket devices by component so each group prints together
+    int* start = (int*)calloc(count + 1, sizeof(int));
+    int* order = (int*)malloc((n + 1) * sizeof(int));
+    if (start != NULL && order != NULL) {
+        for (int v = 0; v < n; v++) start[component[v] + 1]++;
+        for (int c = 0; c < count; c++) start[c + 1] += start[c];
+        int* fill = (int*)malloc((count + 1) * sizeof(int));
+        if (fill != NULL) {
+            memcpy(fill, start, (count + 1) * sizeof(int));
+            for (int v = 0; v < n; v++) order[fill[component[v]]++] = v;
+            free(fill);
+            for (int c = 0; c < count; c++) {
+                if (start[c + 1] - start[c] < 2) continue; // Only report groups that form cycles
+                printf("- {");
+                for (int k = start[c]; k < start[c + 1]; k++) {
+                    printf("%s%s", (k > start[c]) ? ", " : "", deviceName(graph, order[k]));
+                }
+                printf("}\n");
+            }
+        }
+    }
+    free(start);
+    free(order);
+    free(component);
+}
+
+void displayCriticalLinks(Graph* graph) {
+    int n = graph->deviceCount;
+    unsigned char* isArticulation = (unsigned char*)malloc(n + 1);
+    int* bridges = (int*)malloc((2 * n + 1) * sizeof(int));
+    int bridgeCount = 0;
+    int count = (isArticulation && bridges) ? findCriticalLinks(graph, isArticulation, bridges, &bridgeCount) : -1;
+    if (count < 0) {
+        printf("Out of memory during analysis.\n");
+    } else {
+        printf("Articulation devices (failure splits the network): %d\n", count);
+        for (int v = 0; v < n; v++) {
+            if (isArticulation[v]) printf("- %s\n", deviceName(graph, v));
+        }
+        printf("Bridge links (removal splits the network): %d\n", bridgeCount);
+        for (int i = 0; i < bridgeCount; i++) {
+            printf("- %s -- %s\n", deviceName(graph, bridges[2 * i]), deviceName(graph, bridges[2 * i + 1]));
+        }
+    }
+    free(isArticulation);
+    free(bridges);
+}
@@ -0,0 +1,28 @@
+#ifndef ANALYSIS_H
+#define ANALYSIS_H
+
+#include "graph.h"
+#include "threadpool.h"
+
+// Mark every device reachable from source along directed links, never entering
+// blocked (-1 for none). reached must hold deviceCount bytes; returns the count.
+int reachableFrom(const Graph* graph, ThreadPool* pool, int source, int blocked, unsigned char* reached);
+
+// Devices reachable from gateway that lose that path when failed goes down.
+// lost must hold deviceCount ints; returns how many were written.
+int failureImpact(const Graph* graph, ThreadPool* pool, int gateway, int failed, int* lost);
+
+// Tarjan's strongly connected components; component[v] gets a label in 0..count-1
+int stronglyConnectedComponents(const Graph* graph, int* component);
+
+// Articulation points and bridges of the undirected link structure.
+// isArticulation holds deviceCount bytes; bridges holds 2 * (deviceCount - 1) ints
+// as (a, b) pairs and may be NULL. Returns the articulation point count.
+int findCriticalLinks(const Graph* graph, unsigned char* isArticulation, int* bridges, int* bridgeCount);
+
+// Menu-level reports
+void displayFailureImpact(Graph* graph, ThreadPool* pool, const char* gatewayID, const char* failedID);
+void displayStronglyConnectedComponents(Graph* graph);
+void displayCriticalLinks(Graph* graph);
+
+#endif // ANALYSIS_H
@@ -0,0 +1,443 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/resource.h>
+#include "graph.h"
+#include "versions.h"
+
+// Topology-scale benchmark for the graph backends.
+// Usage: ./DeviceMappingBench [max_devices] [seed] [max_readers]
+// Random, scale-free and mesh topologies grow by 10x from 1e3 up to max_devices
+// (default 1e6). Results are CSV on stdout, one row per topology, size and mode.
+// A second CSV table runs versioned readers against a publishing writer on a random
+// topology of max_devices, for 1, 2, 4 ... max_readers reader threads (default: one
+// per online CPU).
+
+#define ID_LEN 16
+#define RANDOM_DEGREE 4        // Directed links per device in the random topology
+#define SCALE_FREE_LINKS 4     // Links each new device attaches with (Barabasi-Albert)
+#define UPDATE_OPS 100000      // Edge inserts, then deletes of the same pairs
+#define REMOVE_OPS 1000        // Device removals, capped at a tenth of the devices
+#define DENSE_MAX_DEVICES 10000 // Largest size also run in dense mode (n^2 / 4 bytes)
+#define VERSION_RUN_MS 2000     // Length of each versioned-readers run
+#define VERSION_BATCH 64        // Links the writer adds per published version
+#define READ_BATCH 64           // Reads between checks of the stop flag
+
+typedef enum {
+    TOPOLOGY_RANDOM,
+    TOPOLOGY_SCALE_FREE,
+    TOPOLOGY_MESH,
+    TOPOLOGY_COUNT
+} Topology;
+
+static const char* topologyNames[TOPOLOGY_COUNT] = { "random", "scale_free", "mesh" };
+
+typedef struct {
+    int* from;
+    int* to;
+    long count;
+    long capacity;
+} EdgeList;
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static long peakRssKb(void) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+static int randomDevice(int n) {
+    return (int)(((size_t)rand() * RAND_MAX + rand()) % n);
+}
+
+static int pushEdge(EdgeList* edges, int from, int to) {
+    if (edges->count == edges->capacity) {
+        long capacity = edges->capacity ? edges->capacity * 2 : 1024;
+        int* newFrom = (int*)realloc(edges->from, capacity * sizeof(int));
+        if (newFrom == NULL) return -1;
+        edges->from = newFrom;
+        int* newTo = (int*)realloc(edges->to, capacity * sizeof(int));
+        if (newTo == NULL) return -1;
+        edges->to = newTo;
+        edges->capacity = capacity;
+    }
+    edges->from[edges->count] = from;
+    edges->to[edges->count] = to;
+    edges->count++;
+    return 0;
+}
+
+// Uniform random directed links, RANDOM_DEGREE per device on average
+static int generateRandom(EdgeList* edges, int n) {
+    for (long i = 0; i < (long)n * RANDOM_DEGREE; i++) {
+        int from = randomDevice(n);
+        int to = randomDevice(n);
+        if (from != to && pushEdge(edges, from, to) != 0) return -1;
+    }
+    return 0;
+}
+
+// Preferential attachment: a device joins by linking to SCALE_FREE_LINKS devices
+// picked in proportion to their degree, giving a few heavily connected hubs
+static int generateScaleFree(EdgeList* edges, int n) {
+    int seed = SCALE_FREE_LINKS + 1;
+    if (n < seed) seed = n;
+    long endpointCapacity = 2L * SCALE_FREE_LINKS * n + (long)seed * seed;
+    int* endpoints = (int*)malloc(endpointCapacity * sizeof(int));
+    if (endpoints == NULL) return -1;
+    long endpointCount = 0;
+    int status = 0;
+
+    for (int a = 0; a < seed && status == 0; a++) {
+        for (int b = 0; b < seed && status == 0; b++) {
+            if (a == b) continue;
+            status = pushEdge(edges, a, b);
+            endpoints[endpointCount++] = a;
+        }
+    }
+    for (int v = seed; v < n && status == 0; v++) {
+        long available = endpointCount;
+        for (int k = 0; k < SCALE_FREE_LINKS && status == 0; k++) {
+            int target = endpoints[((size_t)rand() * RAND_MAX + rand()) % available];
+            status = pushEdge(edges, v, target);
+            endpoints[endpointCount++] = v;
+            endpoints[endpointCount++] = target;
+        }
+    }
+    free(endpoints);
+    return status;
+}
+
+// Square grid, each device linked both ways to its right and lower neighbors
+static int generateMesh(EdgeList* edges, int n) {
+    int width = 1;
+    while (width * width < n) width++;
+    for (int v = 0; v < n; v++) {
+        int right = v + 1;
+        int down = v + width;
+        if (right % width != 0 && right < n) {
+            if (pushEdge(edges, v, right) != 0 || pushEdge(edges, right, v) != 0) return -1;
+        }
+        if (down < n) {
+            if (pushEdge(edges, v, down) != 0 || pushEdge(edges, down, v) != 0) return -1;
+        }
+    }
+    return 0;
+}
+
+// Bytes held by the graph's arrays, counting reserved capacity
+static size_t graphBytes(const Graph* graph) {
+    const InternTable* ids = &graph->ids;
+    size_t bytes = ids->arenaCapacity + (size_t)ids->capacity * (sizeof(int) + sizeof(unsigned int)) +
+                   (size_t)ids->slotCapacity * sizeof(int);
+    if (graph->mode == GRAPH_DENSE) {
+        bytes += 2 * (size_t)graph->deviceCapacity * graph->bits.wordsPerRow * sizeof(uint64_t);
+    } else {
+        bytes += 2 * (size_t)graph->deviceCapacity * sizeof(AdjBlock);
+        bytes += ((size_t)graph->out.poolCapacity + graph->in.poolCapacity) * sizeof(int);
+    }
+    bytes += (size_t)graph->segments.capacity * 2 * sizeof(int);
+    return bytes;
+}
+
+// Visit every neighbor of every device; returns ns per neighbor visited
+static double enumerateAll(const Graph* graph, int incoming, long* sink) {
+    long visited = 0;
+    double start = nowSeconds();
+    for (int v = 0; v < graph->deviceCount; v++) {
+        NeighborIterator it;
+        if (incoming) {
+            beginInNeighbors(graph, v, &it);
+        } else {
+            beginOutNeighbors(graph, v, &it);
+        }
+        for (int w = nextNeighbor(&it); w != -1; w = nextNeighbor(&it)) {
+            *sink += w;
+            visited++;
+        }
+    }
+    double elapsed = nowSeconds() - start;
+    return visited ? elapsed / visited * 1e9 : 0.0;
+}
+
+static void runCase(Topology topology, GraphMode mode, int n, char (*names)[ID_LEN]) {
+    EdgeList edges = { NULL, NULL, 0, 0 };
+    int generated = (topology == TOPOLOGY_RANDOM)       ? generateRandom(&edges, n)
+                    : (topology == TOPOLOGY_SCALE_FREE) ? generateScaleFree(&edges, n)
+                                                        : generateMesh(&edges, n);
+    if (generated != 0) {
+        fprintf(stderr, "Could not generate %s topology of %d devices\n", topologyNames[topology], n);
+        free(edges.from);
+        free(edges.to);
+        return;
+    }
+
+    // Bulk build: every device by ID, then every link by handle
+    Graph graph;
+    double start = nowSeconds();
+    if (mode == GRAPH_DENSE) {
+        initializeDenseGraph(&graph);
+    } else {
+        initializeGraph(&graph);
+    }
+    for (int v = 0; v < n; v++) {
+        addDevice(&graph, names[v]);
+    }
+    for (long e = 0; e < edges.count; e++) {
+        addEdge(&graph, edges.from[e], edges.to[e]);
+    }
+    double buildMs = (nowSeconds() - start) * 1e3;
+    int edgeCount = graph.edgeCount;
+    double graphMib = graphBytes(&graph) / 1048576.0;
+
+    // Edge inserts at random pairs, then removal of the ones that were new
+    int* pairs = (int*)malloc(2 * UPDATE_OPS * sizeof(int));
+    unsigned char* added = (unsigned char*)malloc(UPDATE_OPS);
+    double insertNs = 0.0;
+    double deleteNs = 0.0;
+    if (pairs != NULL && added != NULL) {
+        for (int i = 0; i < UPDATE_OPS; i++) {
+            pairs[2 * i] = randomDevice(n);
+            pairs[2 * i + 1] = randomDevice(n);
+        }
+        start = nowSeconds();
+        for (int i = 0; i < UPDATE_OPS; i++) {
+            added[i] = addEdge(&graph, pairs[2 * i], pairs[2 * i + 1]) == 0;
+        }
+        insertNs = (nowSeconds() - start) / UPDATE_OPS * 1e9;
+        // Pairs that were already linked added nothing, so only real removals are timed per op
+        int removed = 0;
+        start = nowSeconds();
+        for (int i = 0; i < UPDATE_OPS; i++) {
+            if (added[i]) removed += removeEdge(&graph, pairs[2 * i], pairs[2 * i + 1]) == 1;
+        }
+        deleteNs = removed ? (nowSeconds() - start) / removed * 1e9 : 0.0;
+    }
+    free(pairs);
+    free(added);
+
+    long sink = 0;
+    double outNs = enumerateAll(&graph, 0, &sink);
+    double inNs = enumerateAll(&graph, 1, &sink);
+
+    // Device removal last, since it reshuffles handles
+    int removals = (n / 10 < REMOVE_OPS) ? n / 10 : REMOVE_OPS;
+    start = nowSeconds();
+    for (int i = 0; i < removals; i++) {
+        removeDeviceByIndex(&graph, randomDevice(graph.deviceCount));
+    }
+    double removeUs = removals ? (nowSeconds() - start) / removals * 1e6 : 0.0;
+
+    printf("%s,%s,%d,%d,%.3f,%.1f,%.1f,%.2f,%.2f,%.2f,%.2f,%ld\n",
+           topologyNames[topology], (mode == GRAPH_DENSE) ? "dense" : "sparse", n, edgeCount,
+           buildMs, insertNs, deleteNs, outNs, inNs, removeUs, graphMib, peakRssKb());
+    fflush(stdout);
+    if (sink == 42) fprintf(stderr, " "); // Keep the enumeration from being optimized out
+
+    freeGraph(&graph);
+    free(edges.from);
+    free(edges.to);
+}
+
+// ---- Versioned readers against a publishing writer ----
+
+typedef struct {
+    VersionedTopology* store;
+    int reader;
+    const int* stop;
+    long reads;       // Written once the reader stops
+    long sink;
+} ReaderTask;
+
+typedef struct {
+    VersionedTopology* store;
+    const int* stop;
+    unsigned long long random;
+    long publishes;
+    double beginSeconds;   // In versionsBeginUpdate: the copy of the current version
+    double publishSeconds; // Applying the batch and publishing it
+} WriterTask;
+
+// xorshift64, since rand() is shared between threads
+static unsigned long long nextRandom(unsigned long long* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+// Look up the outgoing neighbors of random devices, one read section per lookup
+static void* readerLoop(void* arg) {
+    ReaderTask* task = (ReaderTask*)arg;
+    unsigned long long random = 0x9E3779B97F4A7C15ULL * (unsigned long long)(task->reader + 1);
+    long reads = 0;
+    long sink = 0;
+    while (!__atomic_load_n(task->stop, __ATOMIC_RELAXED)) {
+        for (int i = 0; i < READ_BATCH; i++) {
+            const TopologyVersion* version = versionsAcquire(task->store, task->reader);
+            int device = (int)(nextRandom(&random) % (unsigned long long)version->graph.deviceCount);
+            NeighborIterator it;
+            beginOutNeighbors(&version->graph, device, &it);
+            for (int w = nextNeighbor(&it); w != -1; w = nextNeighbor(&it)) {
+                sink += w;
+            }
+            versionsRelease(task->store, task->reader);
+        }
+        reads += READ_BATCH;
+    }
+    task->reads = reads;
+    task->sink = sink;
+    return NULL;
+}
+
+// Publish batches of VERSION_BATCH new random links until stopped
+static void* writerLoop(void* arg) {
+    WriterTask* task = (WriterTask*)arg;
+    while (!__atomic_load_n(task->stop, __ATOMIC_RELAXED)) {
+        double start = nowSeconds();
+        Graph* draft = versionsBeginUpdate(task->store);
+        if (draft == NULL) break;
+        double copied = nowSeconds();
+        for (int i = 0; i < VERSION_BATCH; i++) {
+            int from = (int)(nextRandom(&task->random) % (unsigned long long)draft->deviceCount);
+            int to = (int)(nextRandom(&task->random) % (unsigned long long)draft->deviceCount);
+            addEdge(draft, from, to);
+        }
+        if (versionsPublish(task->store) != 0) break;
+        task->beginSeconds += copied - start;
+        task->publishSeconds += nowSeconds() - copied;
+        task->publishes++;
+    }
+    return NULL;
+}
+
+// One run of readerCount readers and one writer on a private copy of base
+static void runVersionedReaders(const Graph* base, int readerCount) {
+    Graph graph;
+    VersionedTopology store;
+    if (copyGraph(&graph, base) != 0) {
+        fprintf(stderr, "Could not copy the topology\n");
+        return;
+    }
+    if (versionsInit(&store, &graph, readerCount) != 0) {
+        fprintf(stderr, "Could not create the versioned topology\n");
+        freeGraph(&graph);
+        return;
+    }
+    ReaderTask* readers = (ReaderTask*)calloc(readerCount, sizeof(ReaderTask));
+    pthread_t* threads = (pthread_t*)malloc(readerCount * sizeof(pthread_t));
+    int stop = 0;
+    WriterTask writer = { &store, &stop, 0x2545F4914F6CDD1DULL, 0, 0.0, 0.0 };
+    pthread_t writerThread;
+    int started = 0;
+    double start = nowSeconds();
+    if (readers != NULL && threads != NULL) {
+        for (; started < readerCount; started++) {
+            readers[started] = (ReaderTask){ &store, started, &stop, 0, 0 };
+            if (pthread_create(&threads[started], NULL, readerLoop, &readers[started]) != 0) break;
+        }
+    }
+    int writing = started == readerCount && pthread_create(&writerThread, NULL, writerLoop, &writer) == 0;
+    if (writing) {
+        struct timespec pause = { VERSION_RUN_MS / 1000, (VERSION_RUN_MS % 1000) * 1000000L };
+        nanosleep(&pause, NULL);
+    }
+    __atomic_store_n(&stop, 1, __ATOMIC_RELAXED);
+    for (int r = 0; r < started; r++) {
+        pthread_join(threads[r], NULL);
+    }
+    double elapsed = nowSeconds() - start;
+    if (writing) pthread_join(writerThread, NULL);
+
+    if (writing) {
+        long reads = 0;
+        long sink = 0;
+        for (int r = 0; r < readerCount; r++) {
+            reads += readers[r].reads;
+            sink += readers[r].sink;
+        }
+        double readsPerSecond = reads / elapsed;
+        printf("%d,%d,%d,%.0f,%.0f,%ld,%.2f,%.3f,%ld\n", readerCount, base->deviceCount, base->edgeCount,
+               readsPerSecond, readsPerSecond / readerCount, writer.publishes,
+               writer.publishes ? writer.beginSeconds / writer.publishes * 1e3 : 0.0,
+               writer.publishes ? writer.publishSeconds / writer.publishes * 1e3 : 0.0, peakRssKb());
+        fflush(stdout);
+        if (sink == 42) fprintf(stderr, " "); // Keep the reads from being optimized out
+    } else {
+        fprintf(stderr, "Could not start %d reader threads and a writer\n", readerCount);
+    }
+    free(readers);
+    free(threads);
+    versionsFree(&store);
+}
+
+// Readers querying published versions while a writer keeps publishing; the copy in
+// versionsBeginUpdate is O(n + m) per batch, so it is reported on its own
+static void runVersions(int n, int maxReaders, char (*names)[ID_LEN]) {
+    EdgeList edges = { NULL, NULL, 0, 0 };
+    Graph base;
+    initializeGraph(&base);
+    if (generateRandom(&edges, n) != 0) {
+        fprintf(stderr, "Could not generate random topology of %d devices\n", n);
+    } else {
+        for (int v = 0; v < n; v++) {
+            addDevice(&base, names[v]);
+        }
+        for (long e = 0; e < edges.count; e++) {
+            addEdge(&base, edges.from[e], edges.to[e]);
+        }
+        // reads=per second, begin_update=ms copying the current version, publish=ms for the batch and publish
+        printf("\nreaders,devices,edges,reads_per_sec,reads_per_sec_per_reader,publishes,begin_update_ms,"
+               "publish_ms,rss_kib\n");
+        for (int readers = 1; readers <= maxReaders;
+             readers = (readers < maxReaders && readers * 2 > maxReaders) ? maxReaders : readers * 2) {
+            runVersionedReaders(&base, readers);
+        }
+    }
+    freeGraph(&base);
+    free(edges.from);
+    free(edges.to);
+}
+
+int main(int argc, char* argv[]) {
+    int maxDevices = (argc > 1) ? atoi(argv[1]) : 1000000;
+    unsigned seed = (argc > 2) ? (unsigned)strtoul(argv[2], NULL, 10) : 42;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int maxReaders = (argc > 3) ? atoi(argv[3]) : (cpus > 0 ? (int)cpus : 1);
+    srand(seed);
+
+    char (*names)[ID_LEN] = malloc((size_t)(maxDevices > 0 ? maxDevices : 1) * sizeof(*names));
+    if (names == NULL) {
+        fprintf(stderr, "Could not allocate %d device IDs\n", maxDevices);
+        return 1;
+    }
+    for (int v = 0; v < maxDevices; v++) {
+        snprintf(names[v], ID_LEN, "D%07d", v);
+    }
+
+    // build=ms insert/delete=ns per op enum=ns per neighbor remove=us per device graph=MiB rss=KiB
+    printf("topology,mode,devices,edges,build_ms,insert_ns,delete_ns,out_enum_ns,in_enum_ns,"
+           "remove_device_us,graph_mib,rss_kib\n");
+    for (int t = 0; t < TOPOLOGY_COUNT; t++) {
+        for (int n = 1000; n <= maxDevices; n *= 10) {
+            runCase((Topology)t, GRAPH_SPARSE, n, names);
+            if (n <= DENSE_MAX_DEVICES) {
+                runCase((Topology)t, GRAPH_DENSE, n, names);
+            }
+        }
+    }
+    if (maxDevices > 0 && maxReaders > 0) {
+        runVersions(maxDevices, maxReaders, names);
+    }
+    free(names);
+    return 0;
+}
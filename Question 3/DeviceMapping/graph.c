@@ -2,60 +2,571 @@
 #include <stdlib.h>
 #include <string.h>
 #include "graph.h"
+#include "topology_io.h"
+#include "reach.h"
 
-// Initialize the graph
-void initializeGraph(Graph* graph) {
-    graph->deviceCount = 0;
-    for (int i = 0; i < MAX_DEVICES; i++) {
-        graph->devices[i] = NULL;
-        for (int j = 0; j < MAX_DEVICES; j++) {
-            graph->adjacencyMatrix[i][j] = 0; // No connections initially
+// ---- Adjacency store helpers ----
+
+static void storeInit(AdjacencyStore* store, int deviceCapacity) {
+    store->blocks = (AdjBlock*)calloc(deviceCapacity, sizeof(AdjBlock));
+    store->pool = NULL;
+    store->poolUsed = 0;
+    store->poolCapacity = 0;
+    store->wasted = 0;
+}
+
+static void storeFree(AdjacencyStore* store) {
+    free(store->blocks);
+    free(store->pool);
+    store->blocks = NULL;
+    store->pool = NULL;
+}
+
+static int storeResize(AdjacencyStore* store, int deviceCapacity) {
+    AdjBlock* blocks = (AdjBlock*)realloc(store->blocks, deviceCapacity * sizeof(AdjBlock));
+    if (blocks == NULL) return -1;
+    store->blocks = blocks;
+    return 0;
+}
+
+// Repack every block back to back, dropping the slots abandoned by moved blocks
+static void storeCompact(AdjacencyStore* store, int deviceCount) {
+    int live = 0;
+    for (int v = 0; v < deviceCount; v++) {
+        live += store->blocks[v].capacity;
+    }
+    int* pool = (int*)malloc((live + 1) * sizeof(int));
+    if (pool == NULL) return; // Keep the fragmented layout
+    int used = 0;
+    for (int v = 0; v < deviceCount; v++) {
+        AdjBlock* block = &store->blocks[v];
+        memcpy(pool + used, store->pool + block->offset, block->count * sizeof(int));
+        block->offset = used;
+        used += block->capacity;
+    }
+    free(store->pool);
+    store->pool = pool;
+    store->poolUsed = used;
+    store->poolCapacity = live + 1;
+    store->wasted = 0;
+}
+
+static int storeContains(const AdjacencyStore* store, int v, int w) {
+    const AdjBlock* block = &store->blocks[v];
+    const int* items = store->pool + block->offset;
+    for (int k = 0; k < block->count; k++) {
+        if (items[k] == w) return 1;
+    }
+    return 0;
+}
+
+// Append w to v's block, moving the block to the end of the pool when it is full
+static int storeAppend(AdjacencyStore* store, int v, int w, int deviceCount) {
+    AdjBlock* block = &store->blocks[v];
+    if (block->count == block->capacity) {
+        int newCapacity = block->capacity ? block->capacity * 2 : INITIAL_BLOCK_CAPACITY;
+        int atEnd = block->capacity > 0 && block->offset + block->capacity == store->poolUsed;
+        int needed = atEnd ? store->poolUsed + (newCapacity - block->capacity)
+                           : store->poolUsed + newCapacity;
+        if (needed > store->poolCapacity) {
+            int poolCapacity = store->poolCapacity ? store->poolCapacity : 64;
+            while (poolCapacity < needed) poolCapacity *= 2;
+            int* pool = (int*)realloc(store->pool, poolCapacity * sizeof(int));
+            if (pool == NULL) return -1;
+            store->pool = pool;
+            store->poolCapacity = poolCapacity;
         }
+        if (atEnd) {
+            store->poolUsed = needed;
+        } else {
+            memcpy(store->pool + store->poolUsed, store->pool + block->offset, block->count * sizeof(int));
+            store->wasted += block->capacity;
+            block->offset = store->poolUsed;
+            store->poolUsed = needed;
+        }
+        block->capacity = newCapacity;
+    }
+    store->pool[block->offset + block->count++] = w;
+
+    if (store->wasted > store->poolUsed / 2) {
+        storeCompact(store, deviceCount);
     }
+    return 0;
 }
 
-// Add a device to the graph
-int addDevice(Graph* graph, const char* deviceID) {
-    if (graph->deviceCount >= MAX_DEVICES) {
-        return -1; // Maximum devices reached
+// Remove w from v's block, keeping the remaining neighbors in insertion order
+static int storeRemove(AdjacencyStore* store, int v, int w) {
+    AdjBlock* block = &store->blocks[v];
+    int* items = store->pool + block->offset;
+    for (int k = 0; k < block->count; k++) {
+        if (items[k] == w) {
+            memmove(items + k, items + k + 1, (block->count - k - 1) * sizeof(int));
+            block->count--;
+            return 1;
+        }
     }
-    graph->devices[graph->deviceCount] = strdup(deviceID); // Duplicate the device ID
-    graph->deviceCount++;
-    return 0; // Success
+    return 0;
 }
 
-// Add a connection between devices
-void addConnection(Graph* graph, const char* fromDevice, const char* toDevice) {
-    int fromIndex = -1, toIndex = -1;
+// ---- Bit matrix helpers ----
 
-    // Find indices for fromDevice and toDevice
-    for (int i = 0; i < graph->deviceCount; i++) {
-        if (strcmp(graph->devices[i], fromDevice) == 0) {
-            fromIndex = i;
+static int wordsFor(int bitCount) {
+    return (bitCount + 63) / 64;
+}
+
+static uint64_t* bitRow(uint64_t* base, const BitMatrix* bits, int v) {
+    return base + (size_t)v * bits->wordsPerRow;
+}
+
+static int bitTest(const uint64_t* row, int w) {
+    return (int)((row[w >> 6] >> (w & 63)) & 1);
+}
+
+static void bitSet(uint64_t* row, int w) {
+    row[w >> 6] |= 1ULL << (w & 63);
+}
+
+static void bitClear(uint64_t* row, int w) {
+    row[w >> 6] &= ~(1ULL << (w & 63));
+}
+
+static int bitsInit(BitMatrix* bits, int deviceCapacity) {
+    bits->wordsPerRow = wordsFor(deviceCapacity);
+    size_t words = (size_t)deviceCapacity * bits->wordsPerRow;
+    bits->rows = (uint64_t*)calloc(words, sizeof(uint64_t));
+    bits->cols = (uint64_t*)calloc(words, sizeof(uint64_t));
+    return (bits->rows && bits->cols) ? 0 : -1;
+}
+
+static void bitsFree(BitMatrix* bits) {
+    free(bits->rows);
+    free(bits->cols);
+    bits->rows = NULL;
+    bits->cols = NULL;
+    bits->wordsPerRow = 0;
+}
+
+// Widen both matrices to newCapacity rows and columns, keeping existing bits
+static int bitsResize(BitMatrix* bits, int oldCapacity, int newCapacity) {
+    BitMatrix grown;
+    if (bitsInit(&grown, newCapacity) != 0) {
+        bitsFree(&grown);
+        return -1;
+    }
+    for (int v = 0; v < oldCapacity; v++) {
+        memcpy(bitRow(grown.rows, &grown, v), bitRow(bits->rows, bits, v), bits->wordsPerRow * sizeof(uint64_t));
+        memcpy(bitRow(grown.cols, &grown, v), bitRow(bits->cols, bits, v), bits->wordsPerRow * sizeof(uint64_t));
+    }
+    bitsFree(bits);
+    *bits = grown;
+    return 0;
+}
+
+static int popcountRow(const uint64_t* row, int words) {
+    int count = 0;
+    for (int k = 0; k < words; k++) {
+        count += __builtin_popcountll(row[k]);
+    }
+    return count;
+}
+
+static int validDevice(const Graph* graph, int device) {
+    return device >= 0 && device < graph->deviceCount;
+}
+
+// True when the segment index covers every device and has seen no deletion since
+static int segmentsCurrent(const Graph* graph) {
+    return !graph->segments.dirty && graph->segments.count == graph->deviceCount;
+}
+
+// ---- Handle-based operations ----
+
+// Return the handle of a device ID, or -1 if it does not exist
+int findDevice(const Graph* graph, const char* deviceID) {
+    return internLookup(&graph->ids, deviceID);
+}
+
+const char* deviceName(const Graph* graph, int device) {
+    return internName(&graph->ids, device);
+}
+
+int hasEdge(const Graph* graph, int from, int to) {
+    if (!validDevice(graph, from) || !validDevice(graph, to)) return 0;
+    if (graph->mode == GRAPH_DENSE) {
+        return bitTest(bitRow(graph->bits.rows, &graph->bits, from), to);
+    }
+    return storeContains(&graph->out, from, to);
+}
+
+// Add a directed edge; returns 0 when added, 1 if it already existed, -1 on error
+int addEdge(Graph* graph, int from, int to) {
+    if (!validDevice(graph, from) || !validDevice(graph, to)) {
+        return -1;
+    }
+    if (graph->mapping != NULL && detachSnapshot(graph) != 0) {
+        return -1;
+    }
+    if (graph->mode == GRAPH_DENSE) {
+        uint64_t* row = bitRow(graph->bits.rows, &graph->bits, from);
+        if (bitTest(row, to)) return 1;
+        bitSet(row, to);
+        bitSet(bitRow(graph->bits.cols, &graph->bits, to), from);
+        graph->edgeCount++;
+        if (segmentsCurrent(graph)) segmentsUnion(&graph->segments, from, to);
+        reachEdgeAdded(graph, from, to);
+        return 0;
+    }
+    if (storeContains(&graph->out, from, to)) {
+        return 1; // Edge already present
+    }
+    if (storeAppend(&graph->out, from, to, graph->deviceCount) != 0) {
+        return -1;
+    }
+    if (storeAppend(&graph->in, to, from, graph->deviceCount) != 0) {
+        storeRemove(&graph->out, from, to);
+        return -1;
+    }
+    graph->edgeCount++;
+    if (segmentsCurrent(graph)) segmentsUnion(&graph->segments, from, to);
+    reachEdgeAdded(graph, from, to);
+    return 0;
+}
+
+// Remove a directed edge; returns 1 when removed, 0 if absent, -1 on error
+int removeEdge(Graph* graph, int from, int to) {
+    if (!validDevice(graph, from) || !validDevice(graph, to)) {
+        return -1;
+    }
+    if (graph->mapping != NULL && detachSnapshot(graph) != 0) {
+        return -1;
+    }
+    if (graph->mode == GRAPH_DENSE) {
+        uint64_t* row = bitRow(graph->bits.rows, &graph->bits, from);
+        if (!bitTest(row, to)) return 0;
+        bitClear(row, to);
+        bitClear(bitRow(graph->bits.cols, &graph->bits, to), from);
+        graph->edgeCount--;
+        if (!hasEdge(graph, to, from)) graph->segments.dirty = 1; // May have split a segment
+        reachInvalidate(graph);
+        return 1;
+    }
+    if (!storeRemove(&graph->out, from, to)) {
+        return 0;
+    }
+    storeRemove(&graph->in, to, from);
+    graph->edgeCount--;
+    if (!hasEdge(graph, to, from)) graph->segments.dirty = 1; // May have split a segment
+    reachInvalidate(graph);
+    return 1;
+}
+
+// Rename one neighbor reference inside v's block
+static void storeReplace(AdjacencyStore* store, int v, int from, int to) {
+    AdjBlock* block = &store->blocks[v];
+    int* items = store->pool + block->offset;
+    for (int k = 0; k < block->count; k++) {
+        if (items[k] == from) {
+            items[k] = to;
+            return;
+        }
+    }
+}
+
+// Dense removal: clear the device's edges, then move the last row and column into its slot
+static void removeDenseDevice(Graph* graph, int idx) {
+    BitMatrix* bits = &graph->bits;
+    uint64_t* row = bitRow(bits->rows, bits, idx);
+    uint64_t* col = bitRow(bits->cols, bits, idx);
+    int words = wordsFor(graph->deviceCount);
+    int last = graph->deviceCount - 1;
+    size_t rowBytes = bits->wordsPerRow * sizeof(uint64_t);
+
+    graph->edgeCount -= popcountRow(row, words) + popcountRow(col, words) - bitTest(row, idx);
+    for (int k = 0; k < words; k++) {
+        for (uint64_t word = row[k]; word; word &= word - 1) {
+            bitClear(bitRow(bits->cols, bits, k * 64 + __builtin_ctzll(word)), idx);
+        }
+        for (uint64_t word = col[k]; word; word &= word - 1) {
+            bitClear(bitRow(bits->rows, bits, k * 64 + __builtin_ctzll(word)), idx);
+        }
+    }
+
+    if (idx != last) {
+        memcpy(row, bitRow(bits->rows, bits, last), rowBytes);
+        memcpy(col, bitRow(bits->cols, bits, last), rowBytes);
+        // A self-loop on the moved device now points at its new handle
+        if (bitTest(row, last)) {
+            bitClear(row, last);
+            bitSet(row, idx);
+            bitClear(col, last);
+            bitSet(col, idx);
+        }
+        // Re-point the moved device's neighbors at its new handle
+        for (int k = 0; k < words; k++) {
+            for (uint64_t word = row[k]; word; word &= word - 1) {
+                int w = k * 64 + __builtin_ctzll(word);
+                if (w == idx) continue;
+                bitClear(bitRow(bits->cols, bits, w), last);
+                bitSet(bitRow(bits->cols, bits, w), idx);
+            }
+            for (uint64_t word = col[k]; word; word &= word - 1) {
+                int u = k * 64 + __builtin_ctzll(word);
+                if (u == idx) continue;
+                bitClear(bitRow(bits->rows, bits, u), last);
+                bitSet(bitRow(bits->rows, bits, u), idx);
+            }
+        }
+    }
+    memset(bitRow(bits->rows, bits, last), 0, rowBytes);
+    memset(bitRow(bits->cols, bits, last), 0, rowBytes);
+}
+
+// Sparse removal: detach the device's edges, then move the last device's blocks into its slot
+static void removeSparseDevice(Graph* graph, int idx) {
+    int last = graph->deviceCount - 1;
+
+    AdjBlock* outBlock = &graph->out.blocks[idx];
+    for (int k = 0; k < outBlock->count; k++) {
+        int w = graph->out.pool[outBlock->offset + k];
+        if (w != idx) storeRemove(&graph->in, w, idx);
+    }
+    AdjBlock* inBlock = &graph->in.blocks[idx];
+    for (int k = 0; k < inBlock->count; k++) {
+        int u = graph->in.pool[inBlock->offset + k];
+        if (u != idx) storeRemove(&graph->out, u, idx);
+    }
+    graph->edgeCount -= outBlock->count + inBlock->count;
+    if (storeContains(&graph->out, idx, idx)) {
+        graph->edgeCount++; // A self-loop sits in both lists but is one edge
+    }
+    graph->out.wasted += outBlock->capacity;
+    graph->in.wasted += inBlock->capacity;
+
+    if (idx != last) {
+        graph->out.blocks[idx] = graph->out.blocks[last];
+        graph->in.blocks[idx] = graph->in.blocks[last];
+        // Re-point the moved device's neighbors at its new handle
+        int* items = graph->out.pool + outBlock->offset;
+        for (int k = 0; k < outBlock->count; k++) {
+            if (items[k] == last) items[k] = idx;
+            else storeReplace(&graph->in, items[k], last, idx);
         }
-        if (strcmp(graph->devices[i], toDevice) == 0) {
-            toIndex = i;
+        items = graph->in.pool + inBlock->offset;
+        for (int k = 0; k < inBlock->count; k++) {
+            if (items[k] == last) items[k] = idx;
+            else storeReplace(&graph->out, items[k], last, idx);
         }
     }
+    graph->out.blocks[last] = (AdjBlock){0, 0, 0};
+    graph->in.blocks[last] = (AdjBlock){0, 0, 0};
+}
 
-    if (fromIndex != -1 && toIndex != -1) {
-        graph->adjacencyMatrix[fromIndex][toIndex] = 1; // Set the edge
+// Remove a device and its edges in time proportional to its degree (plus n / 64 words
+// in dense mode). The device holding the last handle moves into the freed handle.
+int removeDeviceByIndex(Graph* graph, int idx) {
+    if (!validDevice(graph, idx)) {
+        return -1;
+    }
+    if (graph->mapping != NULL && detachSnapshot(graph) != 0) {
+        return -1;
+    }
+    if (graph->mode == GRAPH_DENSE) {
+        removeDenseDevice(graph, idx);
     } else {
-        printf("Invalid device ID(s).\n");
+        removeSparseDevice(graph, idx);
     }
+    internRemove(&graph->ids, idx);
+    graph->deviceCount--;
+    graph->segments.dirty = 1; // Rebuilt lazily on the next segment query
+    reachInvalidate(graph);     // Handles moved
+    return 0;
 }
 
-// Display devices connected to a given device
-void displayConnections(Graph* graph, const char* deviceID) {
-    int deviceIndex = -1;
+// ---- Neighbor enumeration ----
 
-    // Find the index of the device
-    for (int i = 0; i < graph->deviceCount; i++) {
-        if (strcmp(graph->devices[i], deviceID) == 0) {
-            deviceIndex = i;
-            break;
+static void beginNeighbors(const Graph* graph, const AdjacencyStore* store, uint64_t* base,
+                           int device, NeighborIterator* it) {
+    if (graph->mode == GRAPH_DENSE) {
+        it->items = NULL;
+        it->count = 0;
+        it->position = 0;
+        it->words = bitRow(base, &graph->bits, device);
+        it->wordCount = wordsFor(graph->deviceCount);
+        it->wordIndex = 0;
+        it->word = it->wordCount ? it->words[0] : 0;
+    } else {
+        const AdjBlock* block = &store->blocks[device];
+        it->items = store->pool + block->offset;
+        it->count = block->count;
+        it->position = 0;
+        it->words = NULL;
+    }
+}
+
+void beginOutNeighbors(const Graph* graph, int device, NeighborIterator* it) {
+    beginNeighbors(graph, &graph->out, graph->bits.rows, device, it);
+}
+
+void beginInNeighbors(const Graph* graph, int device, NeighborIterator* it) {
+    beginNeighbors(graph, &graph->in, graph->bits.cols, device, it);
+}
+
+// Return the next neighbor handle, or -1 when the walk is finished
+int nextNeighbor(NeighborIterator* it) {
+    if (it->words == NULL) {
+        return (it->position < it->count) ? it->items[it->position++] : -1;
+    }
+    while (it->word == 0) {
+        if (++it->wordIndex >= it->wordCount) return -1;
+        it->word = it->words[it->wordIndex];
+    }
+    int bit = __builtin_ctzll(it->word);
+    it->word &= it->word - 1; // Clear the lowest set bit
+    return it->wordIndex * 64 + bit;
+}
+
+int outDegree(const Graph* graph, int device) {
+    if (graph->mode == GRAPH_DENSE) {
+        return popcountRow(bitRow(graph->bits.rows, &graph->bits, device), wordsFor(graph->deviceCount));
+    }
+    return graph->out.blocks[device].count;
+}
+
+int inDegree(const Graph* graph, int device) {
+    if (graph->mode == GRAPH_DENSE) {
+        return popcountRow(bitRow(graph->bits.cols, &graph->bits, device), wordsFor(graph->deviceCount));
+    }
+    return graph->in.blocks[device].count;
+}
+
+// Count devices that both a and b send to; word-parallel AND + popcount in dense mode
+int countCommonConnections(const Graph* graph, int a, int b) {
+    if (graph->mode == GRAPH_DENSE) {
+        const uint64_t* rowA = bitRow(graph->bits.rows, &graph->bits, a);
+        const uint64_t* rowB = bitRow(graph->bits.rows, &graph->bits, b);
+        int words = wordsFor(graph->deviceCount);
+        int count = 0;
+        for (int k = 0; k < words; k++) {
+            count += __builtin_popcountll(rowA[k] & rowB[k]);
         }
+        return count;
+    }
+    const AdjBlock* blockA = &graph->out.blocks[a];
+    const AdjBlock* blockB = &graph->out.blocks[b];
+    if (blockA->count > blockB->count) {
+        int swap = a;
+        a = b;
+        b = swap;
+        blockA = blockB;
+    }
+    int count = 0;
+    for (int k = 0; k < blockA->count; k++) {
+        count += storeContains(&graph->out, b, graph->out.pool[blockA->offset + k]);
+    }
+    return count;
+}
+
+// ---- Graph operations ----
+
+static void initializeGraphMode(Graph* graph, GraphMode mode) {
+    graph->mode = mode;
+    graph->deviceCount = 0;
+    graph->deviceCapacity = INITIAL_DEVICE_CAPACITY;
+    graph->edgeCount = 0;
+    internInit(&graph->ids);
+    graph->out = (AdjacencyStore){0};
+    graph->in = (AdjacencyStore){0};
+    graph->bits = (BitMatrix){0};
+    graph->mapping = NULL;
+    graph->mappingSize = 0;
+    segmentsInit(&graph->segments);
+    graph->reach = NULL;
+    if (mode == GRAPH_DENSE) {
+        bitsInit(&graph->bits, graph->deviceCapacity);
+    } else {
+        storeInit(&graph->out, graph->deviceCapacity);
+        storeInit(&graph->in, graph->deviceCapacity);
     }
+}
+
+// Initialize the graph with sparse adjacency blocks
+void initializeGraph(Graph* graph) {
+    initializeGraphMode(graph, GRAPH_SPARSE);
+}
+
+// Initialize the graph with a bit-packed adjacency matrix for dense clusters
+void initializeDenseGraph(Graph* graph) {
+    initializeGraphMode(graph, GRAPH_DENSE);
+}
+
+// Intern an ID (length bytes, hash precomputed) and give it empty adjacency
+static int addDeviceHashed(Graph* graph, const char* deviceID, size_t length, unsigned int hash) {
+    if (graph->mapping != NULL && detachSnapshot(graph) != 0) {
+        return -1;
+    }
+    if (graph->deviceCount == graph->deviceCapacity) {
+        int capacity = graph->deviceCapacity * 2;
+        if (graph->mode == GRAPH_DENSE) {
+            if (bitsResize(&graph->bits, graph->deviceCapacity, capacity) != 0) {
+                return -1; // Out of memory
+            }
+        } else if (storeResize(&graph->out, capacity) != 0 || storeResize(&graph->in, capacity) != 0) {
+            return -1; // Out of memory
+        }
+        graph->deviceCapacity = capacity;
+    }
+    int index = internAddHashed(&graph->ids, deviceID, length, hash);
+    if (index == -1) {
+        return -1; // Duplicate ID or out of memory
+    }
+    if (graph->mode == GRAPH_SPARSE) {
+        graph->out.blocks[index] = (AdjBlock){0, 0, 0};
+        graph->in.blocks[index] = (AdjBlock){0, 0, 0};
+    }
+    int tracked = segmentsCurrent(graph);
+    graph->deviceCount++;
+    if (tracked && segmentsAdd(&graph->segments) != 0) {
+        graph->segments.dirty = 1;
+    }
+    reachDeviceAdded(graph, index);
+    return index;
+}
+
+// Add a device to the graph; fails on a duplicate ID or when memory runs out
+int addDevice(Graph* graph, const char* deviceID) {
+    size_t length = strlen(deviceID);
+    if (addDeviceHashed(graph, deviceID, length, internHash(deviceID, length)) == -1) {
+        return -1;
+    }
+    return 0; // Success
+}
+
+// Return the handle of an ID given by pointer and length, adding the device if it is new
+int ensureDevice(Graph* graph, const char* deviceID, size_t length, unsigned int hash) {
+    int device = internLookupHashed(&graph->ids, deviceID, length, hash);
+    if (device != -1) {
+        return device;
+    }
+    return addDeviceHashed(graph, deviceID, length, hash);
+}
+
+// Add a connection between devices
+void addConnection(Graph* graph, const char* fromDevice, const char* toDevice) {
+    int fromIndex = findDevice(graph, fromDevice);
+    int toIndex = findDevice(graph, toDevice);
+
+    if (fromIndex == -1 || toIndex == -1) {
+        printf("Invalid device ID(s).\n");
+        return;
+    }
+    if (addEdge(graph, fromIndex, toIndex) == -1) {
+        printf("Out of memory adding connection.\n");
+    }
+}
+
+// Display devices connected to a given device
+void displayConnections(Graph* graph, const char* deviceID) {
+    int deviceIndex = findDevice(graph, deviceID);
 
     if (deviceIndex == -1) {
         printf("Device ID %s not found.\n", deviceID);
@@ -63,29 +574,108 @@ void displayConnections(Graph* graph, const char* deviceID) {
     }
 
     printf("Devices directly communicating with %s:\n", deviceID);
-    for (int j = 0; j < graph->deviceCount; j++) {
-        if (graph->adjacencyMatrix[deviceIndex][j] == 1) {
-            printf("- %s\n", graph->devices[j]);
-        }
+    NeighborIterator it;
+    beginOutNeighbors(graph, deviceIndex, &it);
+    for (int w = nextNeighbor(&it); w != -1; w = nextNeighbor(&it)) {
+        printf("- %s\n", deviceName(graph, w));
     }
 }
 
-// Display the adjacency matrix
+// Display the adjacency matrix, expanded row by row from the outgoing neighbors
 void displayAdjacencyMatrix(Graph* graph) {
     printf("Adjacency Matrix:\n");
+    char* row = (char*)malloc(graph->deviceCount + 1);
+    if (row == NULL) return;
     for (int i = 0; i < graph->deviceCount; i++) {
+        memset(row, 0, graph->deviceCount);
+        NeighborIterator it;
+        beginOutNeighbors(graph, i, &it);
+        for (int w = nextNeighbor(&it); w != -1; w = nextNeighbor(&it)) {
+            row[w] = 1;
+        }
         for (int j = 0; j < graph->deviceCount; j++) {
-            printf("%d ", graph->adjacencyMatrix[i][j]);
+            printf("%d ", row[j]);
         }
         printf("\n");
     }
+    free(row);
 }
 
 // Free the graph's allocated memory
 void freeGraph(Graph* graph) {
-    for (int i = 0; i < graph->deviceCount; i++) {
-        free(graph->devices[i]);
+    if (graph->mapping != NULL) {
+        unmapSnapshot(graph); // Arrays belong to the mapping
+    } else {
+        internFree(&graph->ids);
+        storeFree(&graph->out);
+        storeFree(&graph->in);
+        bitsFree(&graph->bits);
     }
+    segmentsFree(&graph->segments);
+    reachFree(graph);
+    graph->deviceCount = 0;
+    graph->deviceCapacity = 0;
+    graph->edgeCount = 0;
+}
+
+// Copy `used` bytes into a fresh heap block of `capacity` bytes
+static void* duplicate(const void* source, size_t used, size_t capacity) {
+    void* copy = malloc(capacity ? capacity : 1);
+    if (copy != NULL && used > 0) {
+        memcpy(copy, source, used);
+    }
+    return copy;
+}
+
+// Deep-copy graph into heap-owned arrays (also used to detach a mapped snapshot)
+int copyGraph(Graph* copy, const Graph* graph) {
+    *copy = *graph;
+    copy->mapping = NULL;
+    copy->mappingSize = 0;
+    copy->reach = NULL; // Rebuilt on demand
+
+    const InternTable* ids = &graph->ids;
+    copy->ids.arena = (char*)duplicate(ids->arena, ids->arenaUsed, ids->arenaCapacity);
+    copy->ids.offsets = (int*)duplicate(ids->offsets, ids->count * sizeof(int), ids->capacity * sizeof(int));
+    copy->ids.hashes = (unsigned int*)duplicate(ids->hashes, ids->count * sizeof(unsigned int),
+                                                ids->capacity * sizeof(unsigned int));
+    copy->ids.slots = (int*)duplicate(ids->slots, ids->slotCapacity * sizeof(int), ids->slotCapacity * sizeof(int));
+    int ok = copy->ids.arena && copy->ids.offsets && copy->ids.hashes && copy->ids.slots;
+
+    const SegmentIndex* segments = &graph->segments;
+    copy->segments.parent = (int*)duplicate(segments->parent, segments->count * sizeof(int),
+                                            segments->capacity * sizeof(int));
+    copy->segments.size = (int*)duplicate(segments->size, segments->count * sizeof(int),
+                                          segments->capacity * sizeof(int));
+    ok = ok && copy->segments.parent && copy->segments.size;
+
+    copy->out = (AdjacencyStore){0};
+    copy->in = (AdjacencyStore){0};
+    copy->bits = (BitMatrix){0};
+    if (graph->mode == GRAPH_DENSE) {
+        size_t bytes = (size_t)graph->deviceCapacity * graph->bits.wordsPerRow * sizeof(uint64_t);
+        copy->bits.wordsPerRow = graph->bits.wordsPerRow;
+        copy->bits.rows = (uint64_t*)duplicate(graph->bits.rows, bytes, bytes);
+        copy->bits.cols = (uint64_t*)duplicate(graph->bits.cols, bytes, bytes);
+        ok = ok && copy->bits.rows && copy->bits.cols;
+    } else {
+        const AdjacencyStore* sources[2] = { &graph->out, &graph->in };
+        AdjacencyStore* targets[2] = { &copy->out, &copy->in };
+        for (int s = 0; s < 2; s++) {
+            *targets[s] = *sources[s];
+            targets[s]->blocks = (AdjBlock*)duplicate(sources[s]->blocks, graph->deviceCount * sizeof(AdjBlock),
+                                                      graph->deviceCapacity * sizeof(AdjBlock));
+            targets[s]->pool = (int*)duplicate(sources[s]->pool, sources[s]->poolUsed * sizeof(int),
+                                               sources[s]->poolCapacity * sizeof(int));
+            ok = ok && targets[s]->blocks && targets[s]->pool;
+        }
+    }
+
+    if (!ok) {
+        freeGraph(copy);
+        return -1;
+    }
+    return 0;
 }
 
 // Optional advanced features
@@ -95,84 +685,34 @@ void addBidirectionalConnection(Graph* graph, const char* deviceA, const char* d
 }
 
 void removeConnection(Graph* graph, const char* fromDevice, const char* toDevice) {
-    int fromIndex = -1, toIndex = -1;
-    for (int i = 0; i < graph->deviceCount; i++) {
-        if (strcmp(graph->devices[i], fromDevice) == 0) {
-            fromIndex = i;
-        }
-        if (strcmp(graph->devices[i], toDevice) == 0) {
-            toIndex = i;
-        }
-    }
-    if (fromIndex != -1 && toIndex != -1) {
-        graph->adjacencyMatrix[fromIndex][toIndex] = 0;
-    } else {
+    int fromIndex = findDevice(graph, fromDevice);
+    int toIndex = findDevice(graph, toDevice);
+    if (fromIndex == -1 || toIndex == -1) {
         printf("Invalid device ID(s).\n");
+        return;
     }
+    removeEdge(graph, fromIndex, toIndex);
 }
 
 int removeDevice(Graph* graph, const char* deviceID) {
-    int idx = -1;
-    for (int i = 0; i < graph->deviceCount; i++) {
-        if (strcmp(graph->devices[i], deviceID) == 0) {
-            idx = i;
-            break;
-        }
-    }
+    int idx = findDevice(graph, deviceID);
     if (idx == -1) {
         return -1; // not found
     }
-
-    // Shift rows up (remove outgoing edges)
-    for (int r = idx; r < graph->deviceCount - 1; r++) {
-        for (int c = 0; c < graph->deviceCount; c++) {
-            graph->adjacencyMatrix[r][c] = graph->adjacencyMatrix[r + 1][c];
-        }
-    }
-    // Clear last row
-    for (int c = 0; c < graph->deviceCount; c++) {
-        graph->adjacencyMatrix[graph->deviceCount - 1][c] = 0;
-    }
-
-    // Shift columns left (remove incoming edges)
-    for (int c = idx; c < graph->deviceCount - 1; c++) {
-        for (int r = 0; r < graph->deviceCount; r++) {
-            graph->adjacencyMatrix[r][c] = graph->adjacencyMatrix[r][c + 1];
-        }
-    }
-    // Clear last column
-    for (int r = 0; r < graph->deviceCount; r++) {
-        graph->adjacencyMatrix[r][graph->deviceCount - 1] = 0;
-    }
-
-    // Free and shift deviceIDs
-    free(graph->devices[idx]);
-    for (int i = idx; i < graph->deviceCount - 1; i++) {
-        graph->devices[i] = graph->devices[i + 1];
-    }
-    graph->devices[graph->deviceCount - 1] = NULL;
-
-    graph->deviceCount--;
-    return 0;
+    return removeDeviceByIndex(graph, idx);
 }
 
 void displayIncomingConnections(Graph* graph, const char* deviceID) {
-    int deviceIndex = -1;
-    for (int i = 0; i < graph->deviceCount; i++) {
-        if (strcmp(graph->devices[i], deviceID) == 0) {
-            deviceIndex = i;
-            break;
-        }
-    }
+    int deviceIndex = findDevice(graph, deviceID);
     if (deviceIndex == -1) {
         printf("Device ID %s not found.\n", deviceID);
         return;
     }
     printf("Devices sending to %s:\n", deviceID);
-    for (int i = 0; i < graph->deviceCount; i++) {
-        if (graph->adjacencyMatrix[i][deviceIndex] == 1) {
-            printf("- %s\n", graph->devices[i]);
-        }
+    NeighborIterator it;
+    beginInNeighbors(graph, deviceIndex, &it);
+    for (int u = nextNeighbor(&it); u != -1; u = nextNeighbor(&it)) {
+        printf("- %s\n", deviceName(graph, u));
     }
 }
 
@@ -180,3 +720,76 @@ void displayBothConnections(Graph* graph, const char* deviceID) {
     displayConnections(graph, deviceID);
     displayIncomingConnections(graph, deviceID);
 }
+
+void displayCommonConnections(Graph* graph, const char* deviceA, const char* deviceB) {
+    int a = findDevice(graph, deviceA);
+    int b = findDevice(graph, deviceB);
+    if (a == -1 || b == -1) {
+        printf("Invalid device ID(s).\n");
+        return;
+    }
+    printf("Devices that both %s and %s send to (%d):\n", deviceA, deviceB, countCommonConnections(graph, a, b));
+    NeighborIterator it;
+    beginOutNeighbors(graph, a, &it);
+    for (int w = nextNeighbor(&it); w != -1; w = nextNeighbor(&it)) {
+        if (hasEdge(graph, b, w)) {
+            printf("- %s\n", deviceName(graph, w));
+        }
+    }
+}
+
+// ---- Network segments ----
+
+// Rebuild the union-find from scratch after deletions: O(n + m) once per batch of updates
+static int refreshSegments(Graph* graph) {
+    if (segmentsCurrent(graph)) return 0;
+    SegmentIndex* segments = &graph->segments;
+    segmentsReset(segments);
+    for (int v = 0; v < graph->deviceCount; v++) {
+        if (segmentsAdd(segments) != 0) {
+            segments->dirty = 1;
+            return -1;
+        }
+    }
+    for (int v = 0; v < graph->deviceCount; v++) {
+        NeighborIterator it;
+        beginOutNeighbors(graph, v, &it);
+        for (int w = nextNeighbor(&it); w != -1; w = nextNeighbor(&it)) {
+            segmentsUnion(segments, v, w);
+        }
+    }
+    return 0;
+}
+
+// 1 if a and b are linked through any chain of connections, 0 if not, -1 on error
+int sameSegment(Graph* graph, int a, int b) {
+    if (!validDevice(graph, a) || !validDevice(graph, b) || refreshSegments(graph) != 0) return -1;
+    return segmentsFind(&graph->segments, a) == segmentsFind(&graph->segments, b);
+}
+
+int segmentSize(Graph* graph, int device) {
+    if (!validDevice(graph, device) || refreshSegments(graph) != 0) return -1;
+    return graph->segments.size[segmentsFind(&graph->segments, device)];
+}
+
+int countSegments(Graph* graph) {
+    if (refreshSegments(graph) != 0) return -1;
+    return graph->segments.segmentCount;
+}
+
+void displaySegmentInfo(Graph* graph, const char* deviceA, const char* deviceB) {
+    int a = findDevice(graph, deviceA);
+    int b = findDevice(graph, deviceB);
+    if (a == -1 || b == -1) {
+        printf("Invalid device ID(s).\n");
+        return;
+    }
+    int same = sameSegment(graph, a, b);
+    if (same < 0) {
+        printf("Out of memory during analysis.\n");
+        return;
+    }
+    printf("%s and %s are %sin the same network segment.\n", deviceA, deviceB, same ? "" : "not ");
+    printf("Segment of %s: %d device(s); segment of %s: %d device(s); %d segment(s) in total.\n",
+           deviceA, segmentSize(graph, a), deviceB, segmentSize(graph, b), countSegments(graph));
+}
@@ -1,21 +1,78 @@
 #ifndef GRAPH_H
 #define GRAPH_H
 
-#define MAX_DEVICES 10  // Maximum number of devices
+#include <stdint.h>
+#include "intern.h"
+#include "segments.h"
+
+#define INITIAL_DEVICE_CAPACITY 16  // Device slots reserved by initializeGraph
+#define INITIAL_BLOCK_CAPACITY 2    // Neighbor slots reserved per device on first edge
+
+// A device's neighbors occupy one contiguous block of an edge pool
+typedef struct {
+    int offset;   // Start of the block in the pool
+    int count;    // Neighbors stored in the block
+    int capacity; // Slots reserved for the block
+} AdjBlock;
+
+// Growable CSR-style adjacency: one block per device, blocks packed in a shared pool
+typedef struct {
+    AdjBlock* blocks; // Indexed by device index
+    int* pool;        // Neighbor device indices
+    int poolUsed;     // Slots handed out to blocks
+    int poolCapacity; // Slots allocated in the pool
+    int wasted;       // Slots left behind by blocks that moved
+} AdjacencyStore;
+
+// Bit-packed adjacency matrix for dense clusters, 64 edges per word
+typedef struct {
+    uint64_t* rows;  // rows[v] bit w set iff edge v -> w
+    uint64_t* cols;  // Transposed copy: cols[w] bit v set iff edge v -> w
+    int wordsPerRow; // Words in each row (deviceCapacity / 64, rounded up)
+} BitMatrix;
+
+typedef enum {
+    GRAPH_SPARSE, // Adjacency blocks, memory O(n + m)
+    GRAPH_DENSE   // Bit matrix and its transpose, memory O(n^2 / 8) bytes
+} GraphMode;
+
+// Walks the neighbors of one device in either representation
+typedef struct {
+    const int* items;      // Sparse: neighbor block
+    int count;             // Sparse: neighbors in the block
+    int position;          // Sparse: next neighbor to return
+    const uint64_t* words; // Dense: row being scanned
+    int wordCount;         // Dense: words in the row
+    int wordIndex;         // Dense: index of the current word
+    uint64_t word;         // Dense: bits of the current word not yet returned
+} NeighborIterator;
+
+typedef struct ReachIndex ReachIndex; // Reachability cache, see reach.h
 
 typedef struct {
-    char* devices[MAX_DEVICES]; // Array of device IDs
-    int adjacencyMatrix[MAX_DEVICES][MAX_DEVICES]; // Adjacency matrix
-    int deviceCount; // Current number of devices
+    GraphMode mode;     // Representation chosen at initialization
+    InternTable ids;    // Device ID <-> dense handle mapping
+    int deviceCount;    // Current number of devices
+    int deviceCapacity; // Allocated device slots
+    int edgeCount;      // Current number of directed connections
+    AdjacencyStore out; // Outgoing connections per device (sparse mode)
+    AdjacencyStore in;  // Incoming connections per device (sparse mode)
+    BitMatrix bits;     // Adjacency bits and transpose (dense mode)
+    SegmentIndex segments; // Connected segments, merged as links are added
+    ReachIndex* reach;  // Built by the first reachability query, NULL until then
+    void* mapping;      // Snapshot the arrays point into, NULL when heap-owned
+    size_t mappingSize; // Bytes mapped for the snapshot
 } Graph;
 
 // Function prototypes
 void initializeGraph(Graph* graph);
+void initializeDenseGraph(Graph* graph);
 int addDevice(Graph* graph, const char* deviceID);
 void addConnection(Graph* graph, const char* fromDevice, const char* toDevice);
 void displayConnections(Graph* graph, const char* deviceID);
 void displayAdjacencyMatrix(Graph* graph);
 void freeGraph(Graph* graph);
+int copyGraph(Graph* copy, const Graph* graph);
 
 // Optional advanced features
 void addBidirectionalConnection(Graph* graph, const char* deviceA, const char* deviceB);
@@ -24,4 +81,28 @@ int removeDevice(Graph* graph, const char* deviceID);
 void displayIncomingConnections(Graph* graph, const char* deviceID);
 void displayBothConnections(Graph* graph, const char* deviceID);
 
+// Handle-based operations; a handle is a dense device index in 0..deviceCount-1
+int findDevice(const Graph* graph, const char* deviceID);
+int ensureDevice(Graph* graph, const char* deviceID, size_t length, unsigned int hash);
+const char* deviceName(const Graph* graph, int device);
+int hasEdge(const Graph* graph, int from, int to);
+int addEdge(Graph* graph, int from, int to);
+int removeEdge(Graph* graph, int from, int to);
+int removeDeviceByIndex(Graph* graph, int device);
+
+// Neighbor enumeration and degree queries
+void beginOutNeighbors(const Graph* graph, int device, NeighborIterator* it);
+void beginInNeighbors(const Graph* graph, int device, NeighborIterator* it);
+int nextNeighbor(NeighborIterator* it);
+int outDegree(const Graph* graph, int device);
+int inDegree(const Graph* graph, int device);
+int countCommonConnections(const Graph* graph, int a, int b);
+void displayCommonConnections(Graph* graph, const char* deviceA, const char* deviceB);
+
+// Network segment queries (connectivity ignoring link direction)
+int sameSegment(Graph* graph, int a, int b);
+int segmentSize(Graph* graph, int device);
+int countSegments(Graph* graph);
+void displaySegmentInfo(Graph* graph, const char* deviceA, const char* deviceB);
+
 #endif // GRAPH_H
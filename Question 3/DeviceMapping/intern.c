@@ -0,0 +1,199 @@
+#include <stdlib.h>
+#include <string.h>
+#include "intern.h"
+
+// FNV-1a hash of the first length bytes of a device ID
+unsigned int internHash(const char* id, size_t length) {
+    unsigned int hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char)id[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Find the slot holding id, or the empty slot where it would go
+static int findSlot(const InternTable* table, const char* id, size_t length, unsigned int hash) {
+    int mask = table->slotCapacity - 1;
+    int slot = (int)(hash & mask);
+    while (table->slots[slot] != -1) {
+        int handle = table->slots[slot];
+        const char* stored = table->arena + table->offsets[handle];
+        if (table->hashes[handle] == hash && memcmp(stored, id, length) == 0 && stored[length] == '\0') {
+            return slot;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+// Re-insert every handle into the current slots
+static void refillSlots(InternTable* table) {
+    int mask = table->slotCapacity - 1;
+    memset(table->slots, -1, table->slotCapacity * sizeof(int));
+    for (int handle = 0; handle < table->count; handle++) {
+        int slot = (int)(table->hashes[handle] & mask);
+        while (table->slots[slot] != -1) slot = (slot + 1) & mask;
+        table->slots[slot] = handle;
+    }
+}
+
+static int growSlots(InternTable* table, int slotCapacity) {
+    int* slots = (int*)realloc(table->slots, slotCapacity * sizeof(int));
+    if (slots == NULL) return -1;
+    table->slots = slots;
+    table->slotCapacity = slotCapacity;
+    refillSlots(table);
+    return 0;
+}
+
+// Repack live IDs to the front of the arena
+static void compactArena(InternTable* table) {
+    char* arena = (char*)malloc(table->arenaCapacity);
+    if (arena == NULL) return;
+    size_t used = 0;
+    for (int handle = 0; handle < table->count; handle++) {
+        const char* id = table->arena + table->offsets[handle];
+        size_t len = strlen(id) + 1;
+        memcpy(arena + used, id, len);
+        table->offsets[handle] = (int)used;
+        used += len;
+    }
+    free(table->arena);
+    table->arena = arena;
+    table->arenaUsed = used;
+    table->arenaWasted = 0;
+}
+
+void internInit(InternTable* table) {
+    table->arena = NULL;
+    table->arenaUsed = 0;
+    table->arenaCapacity = 0;
+    table->arenaWasted = 0;
+    table->offsets = NULL;
+    table->hashes = NULL;
+    table->count = 0;
+    table->capacity = 0;
+    table->slots = NULL;
+    table->slotCapacity = 0;
+    growSlots(table, INITIAL_INTERN_SLOTS);
+}
+
+void internFree(InternTable* table) {
+    free(table->arena);
+    free(table->offsets);
+    free(table->hashes);
+    free(table->slots);
+    table->arena = NULL;
+    table->offsets = NULL;
+    table->hashes = NULL;
+    table->slots = NULL;
+    table->arenaUsed = table->arenaCapacity = table->arenaWasted = 0;
+    table->count = table->capacity = table->slotCapacity = 0;
+}
+
+// Return the handle of id, or -1 if it has not been interned
+int internLookup(const InternTable* table, const char* id) {
+    size_t length = strlen(id);
+    return internLookupHashed(table, id, length, internHash(id, length));
+}
+
+// Lookup for an ID that is not NUL-terminated, with its hash already computed
+int internLookupHashed(const InternTable* table, const char* id, size_t length, unsigned int hash) {
+    if (table->slotCapacity == 0) return -1;
+    return table->slots[findSlot(table, id, length, hash)];
+}
+
+// Intern a new ID and return its handle, or -1 if it already exists or memory runs out
+int internAdd(InternTable* table, const char* id) {
+    size_t length = strlen(id);
+    return internAddHashed(table, id, length, internHash(id, length));
+}
+
+// Intern length bytes of id (hash precomputed); the arena copy is NUL-terminated
+int internAddHashed(InternTable* table, const char* id, size_t length, unsigned int hash) {
+    if (table->slots[findSlot(table, id, length, hash)] != -1) {
+        return -1; // Duplicate ID
+    }
+
+    // Keep the load factor at or below one half
+    if ((table->count + 1) * 2 > table->slotCapacity) {
+        if (growSlots(table, table->slotCapacity * 2) != 0) return -1;
+    }
+    if (table->count == table->capacity) {
+        int capacity = table->capacity ? table->capacity * 2 : 16;
+        int* offsets = (int*)realloc(table->offsets, capacity * sizeof(int));
+        if (offsets == NULL) return -1;
+        table->offsets = offsets;
+        unsigned int* hashes = (unsigned int*)realloc(table->hashes, capacity * sizeof(unsigned int));
+        if (hashes == NULL) return -1;
+        table->hashes = hashes;
+        table->capacity = capacity;
+    }
+    size_t len = length + 1;
+    if (table->arenaUsed + len > table->arenaCapacity) {
+        size_t capacity = table->arenaCapacity ? table->arenaCapacity : 256;
+        while (capacity < table->arenaUsed + len) capacity *= 2;
+        char* arena = (char*)realloc(table->arena, capacity);
+        if (arena == NULL) return -1;
+        table->arena = arena;
+        table->arenaCapacity = capacity;
+    }
+
+    int handle = table->count++;
+    memcpy(table->arena + table->arenaUsed, id, length);
+    table->arena[table->arenaUsed + length] = '\0';
+    table->offsets[handle] = (int)table->arenaUsed;
+    table->hashes[handle] = hash;
+    table->arenaUsed += len;
+    table->slots[findSlot(table, id, length, hash)] = handle;
+    return handle;
+}
+
+// Find the slot that holds a given handle
+static int slotOfHandle(const InternTable* table, int handle) {
+    int mask = table->slotCapacity - 1;
+    int slot = (int)(table->hashes[handle] & mask);
+    while (table->slots[slot] != handle) slot = (slot + 1) & mask;
+    return slot;
+}
+
+// Empty a slot and pull later probe-chain entries back so lookups never skip a gap
+static void deleteSlot(InternTable* table, int slot) {
+    int mask = table->slotCapacity - 1;
+    int hole = slot;
+    int next = slot;
+    for (;;) {
+        next = (next + 1) & mask;
+        if (table->slots[next] == -1) break;
+        int home = (int)(table->hashes[table->slots[next]] & mask);
+        // Leave the entry if its home lies cyclically in (hole, next]
+        int stays = (hole <= next) ? (hole < home && home <= next) : (hole < home || home <= next);
+        if (!stays) {
+            table->slots[hole] = table->slots[next];
+            hole = next;
+        }
+    }
+    table->slots[hole] = -1;
+}
+
+// Remove a handle in O(1): the last handle moves into its place to keep handles dense
+void internRemove(InternTable* table, int handle) {
+    int last = table->count - 1;
+    table->arenaWasted += strlen(table->arena + table->offsets[handle]) + 1;
+    deleteSlot(table, slotOfHandle(table, handle));
+    if (handle != last) {
+        table->slots[slotOfHandle(table, last)] = handle;
+        table->offsets[handle] = table->offsets[last];
+        table->hashes[handle] = table->hashes[last];
+    }
+    table->count--;
+
+    if (table->arenaWasted > table->arenaUsed / 2) {
+        compactArena(table);
+    }
+}
+
+const char* internName(const InternTable* table, int handle) {
+    return table->arena + table->offsets[handle];
+}
@@ -0,0 +1,33 @@
+#ifndef INTERN_H
+#define INTERN_H
+
+#include <stddef.h>
+
+#define INITIAL_INTERN_SLOTS 32 // Hash slots reserved by internInit (power of two)
+
+// Maps device ID strings to dense integer handles 0..count-1.
+// IDs are packed back to back in one arena; lookups use open addressing.
+typedef struct {
+    char* arena;           // NUL-terminated IDs stored contiguously
+    size_t arenaUsed;      // Bytes handed out
+    size_t arenaCapacity;  // Bytes allocated
+    size_t arenaWasted;    // Bytes belonging to removed IDs
+    int* offsets;          // Arena offset of each handle's ID
+    unsigned int* hashes;  // Cached hash of each handle's ID
+    int count;             // Interned IDs
+    int capacity;          // Allocated handle slots
+    int* slots;            // Hash table of handles, -1 when empty
+    int slotCapacity;      // Number of hash slots (power of two)
+} InternTable;
+
+void internInit(InternTable* table);
+void internFree(InternTable* table);
+unsigned int internHash(const char* id, size_t length);
+int internLookup(const InternTable* table, const char* id);
+int internLookupHashed(const InternTable* table, const char* id, size_t length, unsigned int hash);
+int internAdd(InternTable* table, const char* id);
+int internAddHashed(InternTable* table, const char* id, size_t length, unsigned int hash);
+void internRemove(InternTable* table, int handle);
+const char* internName(const InternTable* table, int handle);
+
+#endif // INTERN_H
@@ -1,10 +1,20 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "graph.h"
+#include "analysis.h"
+#include "topology_io.h"
+#include "reach.h"
 
-int main() {
+int main(int argc, char* argv[]) {
     Graph graph;
-    initializeGraph(&graph);
+    if (argc > 1 && strcmp(argv[1], "--dense") == 0) {
+        initializeDenseGraph(&graph); // Bit-packed matrix for dense clusters
+    } else {
+        initializeGraph(&graph);
+    }
+    ThreadPool pool;
+    threadPoolInit(&pool, 0); // One worker per CPU for graph analytics
 
     // Seed with some example devices and connections
     addDevice(&graph, "D001");
@@ -37,6 +47,15 @@ int main() {
         printf("7. Show incoming connections\n");
         printf("8. Show both incoming and outgoing\n");
         printf("9. Show adjacency matrix\n");
+        printf("10. Show common outgoing connections\n");
+        printf("11. Failure impact from a gateway\n");
+        printf("12. Strongly connected components\n");
+        printf("13. Articulation devices and bridge links\n");
+        printf("14. Import edge list file\n");
+        printf("15. Save binary snapshot\n");
+        printf("16. Load binary snapshot\n");
+        printf("17. Same network segment?\n");
+        printf("18. Can A reach B?\n");
         printf("0. Exit\n");
         printf("Select an option: ");
 
@@ -48,7 +67,9 @@ int main() {
             continue;
         }
 
-        char a[32], b[32];
+        char a[32], b[32], path[256];
+        long imported;
+        Graph loaded;
         switch (choice) {
             case 1:
                 printf("Enter new device ID: ");
@@ -56,7 +77,7 @@ int main() {
                 if (addDevice(&graph, a) == 0) {
                     printf("Device %s added.\n", a);
                 } else {
-                    printf("Failed to add device (limit reached or error).\n");
+                    printf("Failed to add device (duplicate ID or out of memory).\n");
                 }
                 break;
             case 2:
@@ -107,6 +128,65 @@ int main() {
             case 9:
                 displayAdjacencyMatrix(&graph);
                 break;
+            case 10:
+                printf("Enter device A ID: ");
+                scanf("%31s", a);
+                printf("Enter device B ID: ");
+                scanf("%31s", b);
+                displayCommonConnections(&graph, a, b);
+                break;
+            case 11:
+                printf("Enter gateway device ID: ");
+                scanf("%31s", a);
+                printf("Enter failed device ID: ");
+                scanf("%31s", b);
+                displayFailureImpact(&graph, &pool, a, b);
+                break;
+            case 12:
+                displayStronglyConnectedComponents(&graph);
+                break;
+            case 13:
+                displayCriticalLinks(&graph);
+                break;
+            case 14:
+                printf("Enter edge list path: ");
+                scanf("%255s", path);
+                imported = importEdgeList(&graph, &pool, path);
+                if (imported >= 0) {
+                    printf("Imported %ld connection line(s); %d devices, %d connections.\n",
+                           imported, graph.deviceCount, graph.edgeCount);
+                }
+                break;
+            case 15:
+                printf("Enter snapshot path: ");
+                scanf("%255s", path);
+                if (saveSnapshot(&graph, path) == 0) {
+                    printf("Snapshot written to %s.\n", path);
+                }
+                break;
+            case 16:
+                printf("Enter snapshot path: ");
+                scanf("%255s", path);
+                if (loadSnapshot(&loaded, path) == 0) {
+                    freeGraph(&graph);
+                    graph = loaded;
+                    printf("Loaded %d devices, %d connections.\n", graph.deviceCount, graph.edgeCount);
+                }
+                break;
+            case 17:
+                printf("Enter device A ID: ");
+                scanf("%31s", a);
+                printf("Enter device B ID: ");
+                scanf("%31s", b);
+                displaySegmentInfo(&graph, a, b);
+                break;
+            case 18:
+                printf("Enter source device ID: ");
+                scanf("%31s", a);
+                printf("Enter destination device ID: ");
+                scanf("%31s", b);
+                displayReachability(&graph, a, b);
+                break;
             case 0:
                 running = 0;
                 break;
@@ -116,6 +196,7 @@ int main() {
         }
     }
 
+    threadPoolFree(&pool);
     freeGraph(&graph);
     return 0;
 }
@@ -0,0 +1,319 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "reach.h"
+#include "analysis.h"
+
+static uint64_t* closureRow(const ReachIndex* index, int c) {
+    return index->closure + (size_t)c * index->wordsPerRow;
+}
+
+static int closureTest(const ReachIndex* index, int c, int d) {
+    return (int)((closureRow(index, c)[d >> 6] >> (d & 63)) & 1);
+}
+
+// Drop everything derived from the components; the component array is reused
+static void releaseLabels(ReachIndex* index) {
+    free(index->closure);
+    free(index->dagOffsets);
+    free(index->dagTargets);
+    for (int l = 0; l < REACH_LABELS; l++) {
+        free(index->low[l]);
+        free(index->post[l]);
+        index->low[l] = index->post[l] = NULL;
+    }
+    free(index->visited);
+    free(index->stack);
+    index->closure = NULL;
+    index->dagOffsets = index->dagTargets = NULL;
+    index->visited = index->stack = NULL;
+    index->rowCapacity = index->wordsPerRow = 0;
+    index->mode = REACH_STALE;
+}
+
+// Closure rows are built sinks first: Tarjan labels every successor component
+// lower, so its row is complete before it is ORed in, and it only has bits <= its label
+static int buildClosure(const Graph* graph, ReachIndex* index, const int* start, const int* order) {
+    int count = index->componentCount;
+    index->rowCapacity = count + 64; // Room for devices added before the next rebuild
+    index->wordsPerRow = (index->rowCapacity + 63) / 64;
+    index->closure = (uint64_t*)calloc((size_t)index->rowCapacity * index->wordsPerRow, sizeof(uint64_t));
+    int* seen = (int*)malloc((count + 1) * sizeof(int));
+    if (index->closure == NULL || seen == NULL) {
+        free(seen);
+        return -1;
+    }
+    for (int c = 0; c < count; c++) seen[c] = -1;
+
+    for (int c = 0; c < count; c++) {
+        uint64_t* row = closureRow(index, c);
+        row[c >> 6] |= 1ULL << (c & 63);
+        for (int k = start[c]; k < start[c + 1]; k++) {
+            NeighborIterator it;
+            beginOutNeighbors(graph, order[k], &it);
+            for (int w = nextNeighbor(&it); w != -1; w = nextNeighbor(&it)) {
+                int d = index->component[w];
+                if (d == c || seen[d] == c) continue;
+                seen[d] = c;
+                const uint64_t* source = closureRow(index, d);
+                for (int i = 0; i <= (d >> 6); i++) row[i] |= source[i];
+            }
+        }
+    }
+    free(seen);
+    return 0;
+}
+
+// Child visiting order differs per labeling so the intervals prune different pairs
+static int childShift(int c, int label, int degree) {
+    if (label == 0 || degree == 0) return 0;
+    return (int)(((unsigned int)c * 2654435761u + (unsigned int)label * 40503u) % (unsigned int)degree);
+}
+
+// GRAIL-style labels: post-order rank plus the lowest rank below each component,
+// so [low, post] of anything reachable from c nests inside c's interval
+static void labelTraversal(ReachIndex* index, int label, int* position) {
+    int count = index->componentCount;
+    int* low = index->low[label];
+    int* post = index->post[label];
+    int* stack = index->stack;
+    memset(index->visited, 0, count * sizeof(int));
+    int rank = 0;
+
+    for (int root = count - 1; root >= 0; root--) {
+        if (index->visited[root]) continue;
+        index->visited[root] = 1;
+        low[root] = INT_MAX;
+        stack[0] = root;
+        position[0] = 0;
+        int depth = 1;
+        while (depth > 0) {
+            int c = stack[depth - 1];
+            int begin = index->dagOffsets[c];
+            int degree = index->dagOffsets[c + 1] - begin;
+            if (position[depth - 1] < degree) {
+                int k = position[depth - 1]++;
+                int d = index->dagTargets[begin + (k + childShift(c, label, degree)) % degree];
+                if (!index->visited[d]) {
+                    index->visited[d] = 1;
+                    low[d] = INT_MAX;
+                    stack[depth] = d;
+                    position[depth] = 0;
+                    depth++;
+                } else if (low[d] < low[c]) {
+                    low[c] = low[d]; // Already finished: the condensation has no cycles
+                }
+                continue;
+            }
+            post[c] = rank;
+            if (rank < low[c]) low[c] = rank;
+            rank++;
+            depth--;
+            if (depth > 0 && low[c] < low[stack[depth - 1]]) {
+                low[stack[depth - 1]] = low[c];
+            }
+        }
+    }
+}
+
+static int buildIntervals(const Graph* graph, ReachIndex* index, const int* start, const int* order) {
+    int count = index->componentCount;
+    int* seen = (int*)malloc((count + 1) * sizeof(int));
+    int* position = (int*)malloc((count + 1) * sizeof(int));
+    index->dagOffsets = (int*)calloc(count + 1, sizeof(int));
+    index->visited = (int*)malloc((count + 1) * sizeof(int));
+    index->stack = (int*)malloc((count + 1) * sizeof(int));
+    int ok = seen && position && index->dagOffsets && index->visited && index->stack;
+    for (int l = 0; l < REACH_LABELS && ok; l++) {
+        index->low[l] = (int*)malloc((count + 1) * sizeof(int));
+        index->post[l] = (int*)malloc((count + 1) * sizeof(int));
+        ok = index->low[l] && index->post[l];
+    }
+
+    // Condensation edges, deduplicated per component, counted then filled
+    for (int pass = 0; pass < 2 && ok; pass++) {
+        for (int c = 0; c < count; c++) seen[c] = -1;
+        for (int c = 0; c < count; c++) {
+            int fill = pass ? index->dagOffsets[c] : 0;
+            for (int k = start[c]; k < start[c + 1]; k++) {
+                NeighborIterator it;
+                beginOutNeighbors(graph, order[k], &it);
+                for (int w = nextNeighbor(&it); w != -1; w = nextNeighbor(&it)) {
+                    int d = index->component[w];
+                    if (d == c || seen[d] == c) continue;
+                    seen[d] = c;
+                    if (pass) {
+                        index->dagTargets[fill++] = d;
+                    } else {
+                        index->dagOffsets[c + 1]++;
+                    }
+                }
+            }
+        }
+        if (pass == 0) {
+            for (int c = 0; c < count; c++) index->dagOffsets[c + 1] += index->dagOffsets[c];
+            index->dagTargets = (int*)malloc((index->dagOffsets[count] + 1) * sizeof(int));
+            ok = index->dagTargets != NULL;
+        }
+    }
+
+    if (ok) {
+        for (int l = 0; l < REACH_LABELS; l++) labelTraversal(index, l, position);
+        memset(index->visited, 0, count * sizeof(int));
+        index->stamp = 0;
+    }
+    free(seen);
+    free(position);
+    return ok ? 0 : -1;
+}
+
+static int reachBuild(const Graph* graph, ReachIndex* index) {
+    int n = graph->deviceCount;
+    releaseLabels(index);
+    if (n + 1 > index->deviceCapacity) {
+        int capacity = n + 64; // Room for devices added before the next rebuild
+        int* component = (int*)realloc(index->component, capacity * sizeof(int));
+        if (component == NULL) return -1;
+        index->component = component;
+        index->deviceCapacity = capacity;
+    }
+    int count = stronglyConnectedComponents(graph, index->component);
+    if (count < 0) return -1;
+    index->componentCount = count;
+
+    // Devices grouped by component: members of c are order[start[c]..start[c + 1])
+    int* start = (int*)calloc(count + 2, sizeof(int));
+    int* order = (int*)malloc((n + 1) * sizeof(int));
+    int result = -1;
+    if (start != NULL && order != NULL) {
+        for (int v = 0; v < n; v++) start[index->component[v] + 2]++;
+        for (int c = 0; c < count; c++) start[c + 2] += start[c + 1];
+        for (int v = 0; v < n; v++) order[start[index->component[v] + 1]++] = v;
+        result = (count <= REACH_CLOSURE_LIMIT) ? buildClosure(graph, index, start, order)
+                                                : buildIntervals(graph, index, start, order);
+    }
+    free(start);
+    free(order);
+    if (result != 0) {
+        releaseLabels(index);
+        return -1;
+    }
+    index->mode = (count <= REACH_CLOSURE_LIMIT) ? REACH_CLOSURE : REACH_INTERVALS;
+    return 0;
+}
+
+static int intervalsNest(const ReachIndex* index, int outer, int inner) {
+    for (int l = 0; l < REACH_LABELS; l++) {
+        if (index->low[l][inner] < index->low[l][outer] || index->post[l][inner] > index->post[l][outer]) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Exact answer on the condensation: labels refute most pairs outright, and the
+// depth-first search only enters components whose intervals can still contain the target
+static int searchIntervals(ReachIndex* index, int source, int target) {
+    if (source == target) return 1;
+    if (source < target || !intervalsNest(index, source, target)) return 0;
+    if (++index->stamp == INT_MAX) {
+        memset(index->visited, 0, index->componentCount * sizeof(int));
+        index->stamp = 1;
+    }
+    int top = 0;
+    index->stack[top++] = source;
+    index->visited[source] = index->stamp;
+    while (top > 0) {
+        int c = index->stack[--top];
+        for (int k = index->dagOffsets[c]; k < index->dagOffsets[c + 1]; k++) {
+            int d = index->dagTargets[k];
+            if (d == target) return 1;
+            if (d < target || index->visited[d] == index->stamp || !intervalsNest(index, d, target)) continue;
+            index->visited[d] = index->stamp;
+            index->stack[top++] = d;
+        }
+    }
+    return 0;
+}
+
+int canReach(Graph* graph, int from, int to) {
+    if (from < 0 || from >= graph->deviceCount || to < 0 || to >= graph->deviceCount) return -1;
+    if (graph->reach == NULL) {
+        graph->reach = (ReachIndex*)calloc(1, sizeof(ReachIndex));
+        if (graph->reach == NULL) return -1;
+    }
+    ReachIndex* index = graph->reach;
+    if (index->mode == REACH_STALE && reachBuild(graph, index) != 0) return -1;
+
+    int source = index->component[from];
+    int target = index->component[to];
+    if (index->mode == REACH_CLOSURE) {
+        return closureTest(index, source, target);
+    }
+    return searchIntervals(index, source, target);
+}
+
+// Patch the closure in place unless the new link merges components
+void reachEdgeAdded(Graph* graph, int from, int to) {
+    ReachIndex* index = graph->reach;
+    if (index == NULL || index->mode == REACH_STALE) return;
+    int source = index->component[from];
+    int target = index->component[to];
+    if (source == target) return;
+    if (index->mode != REACH_CLOSURE || closureTest(index, target, source)) {
+        index->mode = REACH_STALE; // Intervals are not patchable; a cycle merges components
+        return;
+    }
+    if (closureTest(index, source, target)) return; // Already implied by an existing path
+
+    // Every component reaching source now also reaches everything target reaches
+    const uint64_t* reached = closureRow(index, target);
+    for (int c = 0; c < index->componentCount; c++) {
+        uint64_t* row = closureRow(index, c);
+        if (!closureTest(index, c, source)) continue;
+        for (int i = 0; i < index->wordsPerRow; i++) row[i] |= reached[i];
+    }
+}
+
+// A new device is an isolated component of its own, if the closure has a spare row
+void reachDeviceAdded(Graph* graph, int device) {
+    ReachIndex* index = graph->reach;
+    if (index == NULL || index->mode == REACH_STALE) return;
+    if (index->mode != REACH_CLOSURE || index->componentCount == index->rowCapacity ||
+        device >= index->deviceCapacity) {
+        index->mode = REACH_STALE;
+        return;
+    }
+    int c = index->componentCount++;
+    index->component[device] = c;
+    closureRow(index, c)[c >> 6] |= 1ULL << (c & 63);
+}
+
+// Deletions can split components and cut paths: rebuild on the next query
+void reachInvalidate(Graph* graph) {
+    if (graph->reach != NULL) graph->reach->mode = REACH_STALE;
+}
+
+void reachFree(Graph* graph) {
+    if (graph->reach == NULL) return;
+    releaseLabels(graph->reach);
+    free(graph->reach->component);
+    free(graph->reach);
+    graph->reach = NULL;
+}
+
+void displayReachability(Graph* graph, const char* fromID, const char* toID) {
+    int from = findDevice(graph, fromID);
+    int to = findDevice(graph, toID);
+    if (from == -1 || to == -1) {
+        printf("Invalid device ID(s).\n");
+        return;
+    }
+    int result = canReach(graph, from, to);
+    if (result < 0) {
+        printf("Out of memory during analysis.\n");
+        return;
+    }
+    printf("%s %s reach %s.\n", fromID, result ? "can" : "cannot", toID);
+}
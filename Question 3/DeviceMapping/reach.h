@@ -0,0 +1,46 @@
+#ifndef REACH_H
+#define REACH_H
+
+#include "graph.h"
+
+#define REACH_CLOSURE_LIMIT 16384 // Components up to which the full closure matrix is kept
+#define REACH_LABELS 3            // Interval labels per component in interval mode
+
+typedef enum {
+    REACH_STALE,    // Not built, or invalidated by a topology change
+    REACH_CLOSURE,  // Bit matrix over strongly connected components
+    REACH_INTERVALS // Interval labels on the condensation, with pruned search
+} ReachMode;
+
+// Cached answer to "can device a reach device b", built on first query
+struct ReachIndex {
+    ReachMode mode;
+    int* component;       // Per device: strongly connected component
+    int deviceCapacity;   // Slots in component
+    int componentCount;
+    // Closure mode
+    uint64_t* closure;    // Row c bit d set iff component c reaches component d
+    int rowCapacity;      // Rows allocated, and bits per row
+    int wordsPerRow;
+    // Interval mode: condensation DAG in CSR form, labels sinks first
+    int* dagOffsets;      // componentCount + 1 entries
+    int* dagTargets;
+    int* low[REACH_LABELS];  // Smallest post-order rank below the component
+    int* post[REACH_LABELS]; // Post-order rank of the component
+    int* visited;         // Search stamp per component
+    int* stack;           // Pruned search stack
+    int stamp;
+};
+
+// 1 if a directed path leads from one device to the other, 0 if not, -1 on error
+int canReach(Graph* graph, int from, int to);
+
+// Topology hooks called by graph.c; no-ops until the first query builds the index
+void reachEdgeAdded(Graph* graph, int from, int to);
+void reachDeviceAdded(Graph* graph, int device);
+void reachInvalidate(Graph* graph);
+void reachFree(Graph* graph);
+
+void displayReachability(Graph* graph, const char* fromID, const char* toID);
+
+#endif // REACH_H
@@ -0,0 +1,68 @@
+#include <stdlib.h>
+#include "segments.h"
+
+void segmentsInit(SegmentIndex* segments) {
+    segments->parent = NULL;
+    segments->size = NULL;
+    segments->count = 0;
+    segments->capacity = 0;
+    segments->segmentCount = 0;
+    segments->dirty = 0;
+}
+
+void segmentsFree(SegmentIndex* segments) {
+    free(segments->parent);
+    free(segments->size);
+    segmentsInit(segments);
+}
+
+// Forget every device, keeping the allocation for a rebuild
+void segmentsReset(SegmentIndex* segments) {
+    segments->count = 0;
+    segments->segmentCount = 0;
+    segments->dirty = 0;
+}
+
+// Track the next device handle as a segment of its own; returns 0 on success
+int segmentsAdd(SegmentIndex* segments) {
+    if (segments->count == segments->capacity) {
+        int capacity = segments->capacity ? segments->capacity * 2 : 16;
+        int* parent = (int*)realloc(segments->parent, capacity * sizeof(int));
+        if (parent == NULL) return -1;
+        segments->parent = parent;
+        int* size = (int*)realloc(segments->size, capacity * sizeof(int));
+        if (size == NULL) return -1;
+        segments->size = size;
+        segments->capacity = capacity;
+    }
+    int device = segments->count++;
+    segments->parent[device] = device;
+    segments->size[device] = 1;
+    segments->segmentCount++;
+    return 0;
+}
+
+// Root of the device's segment, halving the path on the way up
+int segmentsFind(SegmentIndex* segments, int device) {
+    int* parent = segments->parent;
+    while (parent[device] != device) {
+        parent[device] = parent[parent[device]];
+        device = parent[device];
+    }
+    return device;
+}
+
+// Merge two segments, hanging the smaller under the larger
+void segmentsUnion(SegmentIndex* segments, int a, int b) {
+    int rootA = segmentsFind(segments, a);
+    int rootB = segmentsFind(segments, b);
+    if (rootA == rootB) return;
+    if (segments->size[rootA] < segments->size[rootB]) {
+        int swap = rootA;
+        rootA = rootB;
+        rootB = swap;
+    }
+    segments->parent[rootB] = rootA;
+    segments->size[rootA] += segments->size[rootB];
+    segments->segmentCount--;
+}
@@ -0,0 +1,21 @@
+#ifndef SEGMENTS_H
+#define SEGMENTS_H
+
+// Union-find over device handles tracking network segments (links taken as undirected)
+typedef struct {
+    int* parent;      // Parent handle; a root is its own parent
+    int* size;        // Devices in the segment, valid at roots
+    int count;        // Devices tracked
+    int capacity;     // Allocated slots
+    int segmentCount; // Number of disjoint segments
+    int dirty;        // A deletion happened; rebuild before answering
+} SegmentIndex;
+
+void segmentsInit(SegmentIndex* segments);
+void segmentsFree(SegmentIndex* segments);
+void segmentsReset(SegmentIndex* segments);
+int segmentsAdd(SegmentIndex* segments);
+int segmentsFind(SegmentIndex* segments, int device);
+void segmentsUnion(SegmentIndex* segments, int a, int b);
+
+#endif // SEGMENTS_H
@@ -0,0 +1,107 @@
+#include <stdlib.h>
+#include <unistd.h>
+#include "threadpool.h"
+
+typedef struct {
+    ThreadPool* pool;
+    int worker;
+} WorkerArgs;
+
+static void* workerLoop(void* arg) {
+    WorkerArgs args = *(WorkerArgs*)arg;
+    ThreadPool* pool = args.pool;
+    free(arg);
+
+    int seen = 0;
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (pool->generation == seen && !pool->shutdown) {
+            pthread_cond_wait(&pool->start, &pool->lock);
+        }
+        if (pool->shutdown) break;
+        seen = pool->generation;
+        PoolTask task = pool->task;
+        void* context = pool->context;
+        pthread_mutex_unlock(&pool->lock);
+
+        task(context, args.worker, pool->threadCount);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->running == 0) {
+            pthread_cond_signal(&pool->done);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+// Start a pool of threadCount workers (0 = one per online CPU); returns 0 on success
+int threadPoolInit(ThreadPool* pool, int threadCount) {
+    if (threadCount <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threadCount = (cpus > 0) ? (int)cpus : 1;
+    }
+    pool->threadCount = 1;
+    pool->generation = 0;
+    pool->running = 0;
+    pool->shutdown = 0;
+    pool->task = NULL;
+    pool->context = NULL;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->start, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    pool->threads = (pthread_t*)malloc(threadCount * sizeof(pthread_t));
+    if (pool->threads == NULL) return -1;
+
+    for (int i = 1; i < threadCount; i++) {
+        WorkerArgs* args = (WorkerArgs*)malloc(sizeof(WorkerArgs));
+        if (args == NULL) break;
+        args->pool = pool;
+        args->worker = i;
+        if (pthread_create(&pool->threads[i - 1], NULL, workerLoop, args) != 0) {
+            free(args);
+            break;
+        }
+        pool->threadCount++;
+    }
+    return 0;
+}
+
+// Run task on every worker and wait until all of them return
+void threadPoolRun(ThreadPool* pool, PoolTask task, void* context) {
+    if (pool == NULL || pool->threadCount == 1) {
+        task(context, 0, 1);
+        return;
+    }
+    pthread_mutex_lock(&pool->lock);
+    pool->task = task;
+    pool->context = context;
+    pool->running = pool->threadCount - 1;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+
+    task(context, 0, pool->threadCount);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->running > 0) {
+        pthread_cond_wait(&pool->done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void threadPoolFree(ThreadPool* pool) {
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = 1;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+    for (int i = 0; i < pool->threadCount - 1; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    free(pool->threads);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->start);
+    pthread_cond_destroy(&pool->done);
+    pool->threads = NULL;
+    pool->threadCount = 0;
+}
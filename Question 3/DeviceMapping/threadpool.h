@@ -0,0 +1,26 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <pthread.h>
+
+// Task run by every worker: worker is 0..workers-1, the caller acts as worker 0
+typedef void (*PoolTask)(void* context, int worker, int workers);
+
+typedef struct {
+    pthread_t* threads;   // Helper threads (threadCount - 1 of them)
+    int threadCount;      // Workers including the calling thread
+    pthread_mutex_t lock; // Guards the fields below
+    pthread_cond_t start; // Signalled when a new task is posted
+    pthread_cond_t done;  // Signalled when the last helper finishes
+    PoolTask task;        // Task being run
+    void* context;        // Argument for the task
+    int generation;       // Bumped for each posted task
+    int running;          // Helpers still working on the current task
+    int shutdown;         // Set by threadPoolFree
+} ThreadPool;
+
+int threadPoolInit(ThreadPool* pool, int threadCount);
+void threadPoolRun(ThreadPool* pool, PoolTask task, void* context);
+void threadPoolFree(ThreadPool* pool);
+
+#endif // THREADPOOL_H
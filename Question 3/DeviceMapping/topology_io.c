@@ -0,0 +1,519 @@
+#define _DEFAULT_SOURCE // mmap flags under -std=c11
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "topology_io.h"
+
+// ---- Parallel edge-list import ----
+
+// One parsed line: token positions inside the mapped file, never copied out
+typedef struct {
+    size_t fromOffset;
+    size_t toOffset;
+    int fromLength;
+    int toLength;          // 0 when the line only declares a device
+    unsigned int fromHash;
+    unsigned int toHash;
+} ParsedLine;
+
+typedef struct {
+    ParsedLine* lines;
+    size_t count;
+    size_t capacity;
+    int failed;            // Set if the worker ran out of memory
+} ParsedChunk;
+
+typedef struct {
+    const char* data;
+    size_t size;
+    ParsedChunk* chunks;   // One per worker, applied in file order
+} ImportJob;
+
+static int isSeparator(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == ',';
+}
+
+// First line start at or after pos; chunk boundaries from every worker agree on it
+static size_t lineStart(const char* data, size_t size, size_t pos) {
+    if (pos == 0) return 0;
+    while (pos < size && data[pos - 1] != '\n') pos++;
+    return pos;
+}
+
+// Tokenize this worker's share of the file and hash every ID
+static void parseTask(void* context, int worker, int workers) {
+    ImportJob* job = (ImportJob*)context;
+    const char* data = job->data;
+    ParsedChunk* chunk = &job->chunks[worker];
+    size_t start = lineStart(data, job->size, job->size / workers * worker);
+    size_t end = (worker == workers - 1) ? job->size
+                                         : lineStart(data, job->size, job->size / workers * (worker + 1));
+
+    size_t p = start;
+    while (p < end) {
+        while (p < end && isSeparator(data[p])) p++;
+        if (p >= end) break;
+        if (data[p] == '\n') {
+            p++;
+            continue;
+        }
+        if (data[p] == '#') {
+            while (p < end && data[p] != '\n') p++;
+            continue;
+        }
+
+        ParsedLine line = {0};
+        size_t q = p;
+        while (q < end && !isSeparator(data[q]) && data[q] != '\n') q++;
+        line.fromOffset = p;
+        line.fromLength = (int)(q - p);
+        line.fromHash = internHash(data + p, q - p);
+
+        p = q;
+        while (p < end && isSeparator(data[p])) p++;
+        if (p < end && data[p] != '\n') {
+            q = p;
+            while (q < end && !isSeparator(data[q]) && data[q] != '\n') q++;
+            line.toOffset = p;
+            line.toLength = (int)(q - p);
+            line.toHash = internHash(data + p, q - p);
+            p = q;
+        }
+        while (p < end && data[p] != '\n') p++; // Ignore trailing columns
+
+        if (chunk->count == chunk->capacity) {
+            size_t capacity = chunk->capacity ? chunk->capacity * 2 : 1024;
+            ParsedLine* lines = (ParsedLine*)realloc(chunk->lines, capacity * sizeof(ParsedLine));
+            if (lines == NULL) {
+                chunk->failed = 1;
+                return;
+            }
+            chunk->lines = lines;
+            chunk->capacity = capacity;
+        }
+        chunk->lines[chunk->count++] = line;
+    }
+}
+
+long importEdgeList(Graph* graph, ThreadPool* pool, const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror("Could not open edge list");
+        return -1;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        perror("Could not stat edge list");
+        close(fd);
+        return -1;
+    }
+    if (info.st_size == 0) {
+        close(fd);
+        return 0;
+    }
+    size_t size = (size_t)info.st_size;
+    const char* data = (const char*)mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        perror("Could not map edge list");
+        return -1;
+    }
+    madvise((void*)data, size, MADV_SEQUENTIAL);
+
+    int workers = (pool != NULL) ? pool->threadCount : 1;
+    ImportJob job = { data, size, (ParsedChunk*)calloc(workers, sizeof(ParsedChunk)) };
+    long edges = -1;
+    if (job.chunks != NULL) {
+        threadPoolRun(pool, parseTask, &job);
+
+        // Interning and insertion stay sequential, in file order, on pre-hashed tokens
+        edges = 0;
+        for (int w = 0; w < workers && edges >= 0; w++) {
+            if (job.chunks[w].failed) {
+                edges = -1;
+                break;
+            }
+            for (size_t i = 0; i < job.chunks[w].count; i++) {
+                const ParsedLine* line = &job.chunks[w].lines[i];
+                int from = ensureDevice(graph, data + line->fromOffset, line->fromLength, line->fromHash);
+                if (from == -1) {
+                    edges = -1;
+                    break;
+                }
+                if (line->toLength == 0) continue;
+                int to = ensureDevice(graph, data + line->toOffset, line->toLength, line->toHash);
+                if (to == -1 || addEdge(graph, from, to) == -1) {
+                    edges = -1;
+                    break;
+                }
+                edges++;
+            }
+        }
+        if (edges < 0) {
+            fprintf(stderr, "Out of memory importing %s\n", path);
+        }
+        for (int w = 0; w < workers; w++) {
+            free(job.chunks[w].lines);
+        }
+        free(job.chunks);
+    }
+    munmap((void*)data, size);
+    return edges;
+}
+
+// ---- Binary snapshots ----
+
+enum {
+    SECTION_ARENA,
+    SECTION_ID_OFFSETS,
+    SECTION_ID_HASHES,
+    SECTION_SLOTS,
+    SECTION_OUT_BLOCKS,
+    SECTION_OUT_POOL,
+    SECTION_IN_BLOCKS,
+    SECTION_IN_POOL,
+    SECTION_ROWS,
+    SECTION_COLS,
+    SECTION_COUNT
+};
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;     // 0x01020304 in the writer's byte order
+    int32_t mode;
+    int32_t deviceCount;
+    int32_t deviceCapacity;
+    int32_t edgeCount;
+    int32_t idCount;
+    int32_t slotCapacity;
+    uint64_t arenaUsed;
+    uint64_t arenaWasted;
+    int32_t poolUsed[2];    // Out, in
+    int32_t wasted[2];
+    int32_t wordsPerRow;
+    int32_t reserved;
+    uint64_t offset[SECTION_COUNT];
+    uint64_t size[SECTION_COUNT];
+} SnapshotHeader;
+
+static uint64_t alignUp(uint64_t value) {
+    return (value + SNAPSHOT_ALIGN - 1) / SNAPSHOT_ALIGN * SNAPSHOT_ALIGN;
+}
+
+int saveSnapshot(const Graph* graph, const char* path) {
+    SnapshotHeader header;
+    const void* section[SECTION_COUNT] = {0};
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, 8);
+    header.version = SNAPSHOT_VERSION;
+    header.byteOrder = 0x01020304u;
+    header.mode = graph->mode;
+    header.deviceCount = graph->deviceCount;
+    header.deviceCapacity = graph->deviceCapacity;
+    header.edgeCount = graph->edgeCount;
+    header.idCount = graph->ids.count;
+    header.slotCapacity = graph->ids.slotCapacity;
+    header.arenaUsed = graph->ids.arenaUsed;
+    header.arenaWasted = graph->ids.arenaWasted;
+
+    section[SECTION_ARENA] = graph->ids.arena;
+    header.size[SECTION_ARENA] = graph->ids.arenaUsed;
+    section[SECTION_ID_OFFSETS] = graph->ids.offsets;
+    header.size[SECTION_ID_OFFSETS] = graph->ids.count * sizeof(int);
+    section[SECTION_ID_HASHES] = graph->ids.hashes;
+    header.size[SECTION_ID_HASHES] = graph->ids.count * sizeof(unsigned int);
+    section[SECTION_SLOTS] = graph->ids.slots;
+    header.size[SECTION_SLOTS] = graph->ids.slotCapacity * sizeof(int);
+    if (graph->mode == GRAPH_DENSE) {
+        size_t bytes = (size_t)graph->deviceCapacity * graph->bits.wordsPerRow * sizeof(uint64_t);
+        header.wordsPerRow = graph->bits.wordsPerRow;
+        section[SECTION_ROWS] = graph->bits.rows;
+        header.size[SECTION_ROWS] = bytes;
+        section[SECTION_COLS] = graph->bits.cols;
+        header.size[SECTION_COLS] = bytes;
+    } else {
+        const AdjacencyStore* stores[2] = { &graph->out, &graph->in };
+        for (int s = 0; s < 2; s++) {
+            header.poolUsed[s] = stores[s]->poolUsed;
+            header.wasted[s] = stores[s]->wasted;
+            section[SECTION_OUT_BLOCKS + 2 * s] = stores[s]->blocks;
+            header.size[SECTION_OUT_BLOCKS + 2 * s] = graph->deviceCount * sizeof(AdjBlock);
+            section[SECTION_OUT_POOL + 2 * s] = stores[s]->pool;
+            header.size[SECTION_OUT_POOL + 2 * s] = stores[s]->poolUsed * sizeof(int);
+        }
+    }
+
+    uint64_t position = alignUp(sizeof(header));
+    for (int k = 0; k < SECTION_COUNT; k++) {
+        header.offset[k] = position;
+        position = alignUp(position + header.size[k]);
+    }
+
+    // Write beside the target and rename over it: the graph may still be reading from a
+    // mapping of that very file, which truncating it in place would pull out from under it
+    size_t pathLength = strlen(path);
+    char* temporary = (char*)malloc(pathLength + sizeof(".tmp"));
+    if (temporary == NULL) {
+        fprintf(stderr, "Out of memory saving %s\n", path);
+        return -1;
+    }
+    memcpy(temporary, path, pathLength);
+    memcpy(temporary + pathLength, ".tmp", sizeof(".tmp"));
+    FILE* file = fopen(temporary, "wb");
+    if (!file) {
+        perror("Could not create snapshot");
+        free(temporary);
+        return -1;
+    }
+    static const char padding[SNAPSHOT_ALIGN];
+    int ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    uint64_t written = sizeof(header);
+    for (int k = 0; k < SECTION_COUNT && ok; k++) {
+        ok = fwrite(padding, 1, header.offset[k] - written, file) == header.offset[k] - written;
+        if (ok && header.size[k] > 0) {
+            ok = fwrite(section[k], 1, header.size[k], file) == header.size[k];
+        }
+        written = header.offset[k] + header.size[k];
+    }
+    if (fclose(file) != 0) ok = 0;
+    if (!ok) {
+        perror("Could not write snapshot");
+        remove(temporary);
+        free(temporary);
+        return -1;
+    }
+    if (rename(temporary, path) != 0) {
+        perror("Could not replace snapshot");
+        remove(temporary);
+        free(temporary);
+        return -1;
+    }
+    free(temporary);
+    return 0;
+}
+
+// Check that every section fits in the file and matches the counts in the header
+static int validHeader(const SnapshotHeader* header, size_t fileSize) {
+    if (memcmp(header->magic, SNAPSHOT_MAGIC, 8) != 0 || header->version != SNAPSHOT_VERSION ||
+        header->byteOrder != 0x01020304u) {
+        return 0;
+    }
+    if (header->deviceCount < 0 || header->idCount != header->deviceCount ||
+        header->deviceCapacity < header->deviceCount || header->slotCapacity <= 0 ||
+        (header->slotCapacity & (header->slotCapacity - 1)) != 0) {
+        return 0;
+    }
+    for (int k = 0; k < SECTION_COUNT; k++) {
+        if (header->offset[k] % SNAPSHOT_ALIGN != 0 || header->offset[k] > fileSize ||
+            header->size[k] > fileSize - header->offset[k]) {
+            return 0;
+        }
+    }
+    uint64_t expected[SECTION_COUNT] = {0};
+    expected[SECTION_ARENA] = header->arenaUsed;
+    expected[SECTION_ID_OFFSETS] = (uint64_t)header->idCount * sizeof(int);
+    expected[SECTION_ID_HASHES] = (uint64_t)header->idCount * sizeof(unsigned int);
+    expected[SECTION_SLOTS] = (uint64_t)header->slotCapacity * sizeof(int);
+    if (header->mode == GRAPH_DENSE) {
+        if (header->wordsPerRow != (header->deviceCapacity + 63) / 64) return 0;
+        expected[SECTION_ROWS] = (uint64_t)header->deviceCapacity * header->wordsPerRow * sizeof(uint64_t);
+        expected[SECTION_COLS] = expected[SECTION_ROWS];
+    } else if (header->mode == GRAPH_SPARSE) {
+        for (int s = 0; s < 2; s++) {
+            expected[SECTION_OUT_BLOCKS + 2 * s] = (uint64_t)header->deviceCount * sizeof(AdjBlock);
+            expected[SECTION_OUT_POOL + 2 * s] = (uint64_t)header->poolUsed[s] * sizeof(int);
+        }
+    } else {
+        return 0;
+    }
+    for (int k = 0; k < SECTION_COUNT; k++) {
+        if (header->size[k] != expected[k]) return 0;
+    }
+    if (header->edgeCount < 0 || header->arenaWasted > header->arenaUsed) return 0;
+    for (int s = 0; s < 2; s++) {
+        if (header->poolUsed[s] < 0 || header->wasted[s] < 0 || header->wasted[s] > header->poolUsed[s]) return 0;
+    }
+    return 1;
+}
+
+// Check that a set of adjacency blocks stays inside its pool and names only live devices
+static int validStore(const AdjBlock* blocks, const int* pool, int deviceCount, int poolUsed, long* edges) {
+    for (int v = 0; v < deviceCount; v++) {
+        const AdjBlock* block = &blocks[v];
+        if (block->offset < 0 || block->count < 0 || block->count > block->capacity ||
+            block->capacity > poolUsed - block->offset) {
+            return 0;
+        }
+        for (int i = 0; i < block->count; i++) {
+            int w = pool[block->offset + i];
+            if (w < 0 || w >= deviceCount) return 0;
+        }
+        *edges += block->count;
+    }
+    return 1;
+}
+
+// Check the mapped arrays themselves, since they are used as they are: every ID offset
+// inside the arena, every hash slot empty or naming a handle exactly once, every
+// neighbor a live device, and the degrees adding up to the edge count. One pass over the
+// file, O(n + m) for sparse graphs. Returns 1 if valid, 0 if not, -1 if out of memory.
+static int validContents(const SnapshotHeader* header, const char* base) {
+    const char* arena = base + header->offset[SECTION_ARENA];
+    const int* offsets = (const int*)(base + header->offset[SECTION_ID_OFFSETS]);
+    const int* slots = (const int*)(base + header->offset[SECTION_SLOTS]);
+    int deviceCount = header->deviceCount;
+
+    // With the arena ending in NUL, every offset inside it starts a terminated name
+    if (header->arenaUsed > 0 && arena[header->arenaUsed - 1] != '\0') return 0;
+    for (int h = 0; h < header->idCount; h++) {
+        if (offsets[h] < 0 || (uint64_t)offsets[h] >= header->arenaUsed) return 0;
+    }
+
+    // Probing stops at an empty slot and removal searches for the handle's own slot
+    if (header->idCount >= header->slotCapacity) return 0;
+    unsigned char* seen = (unsigned char*)calloc(header->idCount > 0 ? header->idCount : 1, 1);
+    if (seen == NULL) return -1;
+    int valid = 1;
+    for (int slot = 0; slot < header->slotCapacity && valid; slot++) {
+        int h = slots[slot];
+        if (h == -1) continue;
+        if (h < 0 || h >= header->idCount || seen[h]) valid = 0;
+        else seen[h] = 1;
+    }
+    for (int h = 0; h < header->idCount && valid; h++) {
+        if (!seen[h]) valid = 0;
+    }
+    free(seen);
+    if (!valid) return 0;
+
+    if (header->mode == GRAPH_DENSE) {
+        // No bits outside the live deviceCount x deviceCount corner
+        const uint64_t* matrices[2] = { (const uint64_t*)(base + header->offset[SECTION_ROWS]),
+                                        (const uint64_t*)(base + header->offset[SECTION_COLS]) };
+        int words = header->wordsPerRow;
+        int liveWords = (deviceCount + 63) / 64;
+        uint64_t lastMask = (deviceCount % 64) ? (1ULL << (deviceCount % 64)) - 1 : ~0ULL;
+        for (int m = 0; m < 2; m++) {
+            long edges = 0;
+            for (int v = 0; v < header->deviceCapacity; v++) {
+                const uint64_t* row = matrices[m] + (size_t)v * words;
+                for (int k = 0; k < words; k++) {
+                    uint64_t allowed = (v >= deviceCount || k >= liveWords) ? 0
+                                     : (k == liveWords - 1) ? lastMask : ~0ULL;
+                    if (row[k] & ~allowed) return 0;
+                    edges += __builtin_popcountll(row[k]);
+                }
+            }
+            if (edges != header->edgeCount) return 0;
+        }
+    } else {
+        for (int s = 0; s < 2; s++) {
+            long edges = 0;
+            if (!validStore((const AdjBlock*)(base + header->offset[SECTION_OUT_BLOCKS + 2 * s]),
+                            (const int*)(base + header->offset[SECTION_OUT_POOL + 2 * s]), deviceCount,
+                            header->poolUsed[s], &edges) ||
+                edges != header->edgeCount) {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+int loadSnapshot(Graph* graph, const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror("Could not open snapshot");
+        return -1;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(SnapshotHeader)) {
+        fprintf(stderr, "%s is not a device snapshot\n", path);
+        close(fd);
+        return -1;
+    }
+    size_t size = (size_t)info.st_size;
+    // Private mapping: in-place writes would stay local to this process
+    char* base = (char*)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        perror("Could not map snapshot");
+        return -1;
+    }
+    const SnapshotHeader* header = (const SnapshotHeader*)base;
+    if (!validHeader(header, size)) {
+        fprintf(stderr, "%s is not a compatible device snapshot\n", path);
+        munmap(base, size);
+        return -1;
+    }
+    int contents = validContents(header, base);
+    if (contents != 1) {
+        if (contents < 0) fprintf(stderr, "Out of memory checking %s\n", path);
+        else fprintf(stderr, "%s is a corrupted device snapshot\n", path);
+        munmap(base, size);
+        return -1;
+    }
+
+    memset(graph, 0, sizeof(*graph));
+    graph->mode = (GraphMode)header->mode;
+    graph->deviceCount = header->deviceCount;
+    graph->edgeCount = header->edgeCount;
+    graph->mapping = base;
+    graph->mappingSize = size;
+    segmentsInit(&graph->segments); // Rebuilt from the adjacency on the first segment query
+
+    InternTable* ids = &graph->ids;
+    ids->arena = base + header->offset[SECTION_ARENA];
+    ids->arenaUsed = header->arenaUsed;
+    ids->arenaCapacity = header->arenaUsed;
+    ids->arenaWasted = header->arenaWasted;
+    ids->offsets = (int*)(base + header->offset[SECTION_ID_OFFSETS]);
+    ids->hashes = (unsigned int*)(base + header->offset[SECTION_ID_HASHES]);
+    ids->count = header->idCount;
+    ids->capacity = header->idCount;
+    ids->slots = (int*)(base + header->offset[SECTION_SLOTS]);
+    ids->slotCapacity = header->slotCapacity;
+
+    if (graph->mode == GRAPH_DENSE) {
+        graph->deviceCapacity = header->deviceCapacity;
+        graph->bits.rows = (uint64_t*)(base + header->offset[SECTION_ROWS]);
+        graph->bits.cols = (uint64_t*)(base + header->offset[SECTION_COLS]);
+        graph->bits.wordsPerRow = header->wordsPerRow;
+    } else {
+        // Only deviceCount blocks are stored; growth happens after detaching
+        graph->deviceCapacity = (header->deviceCount > 0) ? header->deviceCount : 1;
+        AdjacencyStore* stores[2] = { &graph->out, &graph->in };
+        for (int s = 0; s < 2; s++) {
+            stores[s]->blocks = (AdjBlock*)(base + header->offset[SECTION_OUT_BLOCKS + 2 * s]);
+            stores[s]->pool = (int*)(base + header->offset[SECTION_OUT_POOL + 2 * s]);
+            stores[s]->poolUsed = header->poolUsed[s];
+            stores[s]->poolCapacity = header->poolUsed[s];
+            stores[s]->wasted = header->wasted[s];
+        }
+    }
+    return 0;
+}
+
+int detachSnapshot(Graph* graph) {
+    Graph copy;
+    if (copyGraph(&copy, graph) != 0) {
+        return -1;
+    }
+    unmapSnapshot(graph);
+    segmentsFree(&graph->segments); // The copy holds its own
+    copy.reach = graph->reach;      // Same topology, so the cached index stays valid
+    *graph = copy;
+    return 0;
+}
+
+void unmapSnapshot(Graph* graph) {
+    if (graph->mapping == NULL) return;
+    munmap(graph->mapping, graph->mappingSize);
+    graph->mapping = NULL;
+    graph->mappingSize = 0;
+}
@@ -0,0 +1,32 @@
+#ifndef TOPOLOGY_IO_H
+#define TOPOLOGY_IO_H
+
+#include "graph.h"
+#include "threadpool.h"
+
+#define SNAPSHOT_MAGIC "DMAPSNAP" // First 8 bytes of every snapshot file
+#define SNAPSHOT_VERSION 1
+#define SNAPSHOT_ALIGN 64         // Sections start on cache-line boundaries
+
+// Bulk-load "FROM TO" lines (one device ID per line declares an isolated device).
+// Blank lines and lines starting with '#' are skipped; unknown IDs become new devices.
+// Returns the number of edge lines read, or -1 if the file cannot be read or memory runs
+// out. Lines are applied in file order, so after running out of memory the graph keeps
+// the devices and edges of every line before the one that failed, and nothing after it.
+long importEdgeList(Graph* graph, ThreadPool* pool, const char* path);
+
+// Write the graph's arrays verbatim; returns 0 on success. The file is written as path.tmp
+// and renamed over path, so a graph mapped from path itself can be saved back to it.
+int saveSnapshot(const Graph* graph, const char* path);
+
+// Map a snapshot straight into a ready graph without parsing or copying; returns 0 on success.
+// The header and the mapped arrays are checked first (one O(n + m) pass), so a corrupted
+// file is rejected rather than crashing later queries. The graph reads from the mapping
+// until its first update copies it onto the heap.
+int loadSnapshot(Graph* graph, const char* path);
+
+// Copy a mapped graph onto the heap and release the mapping; returns 0 on success
+int detachSnapshot(Graph* graph);
+void unmapSnapshot(Graph* graph);
+
+#endif // TOPOLOGY_IO_H
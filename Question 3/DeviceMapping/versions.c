@@ -0,0 +1,121 @@
+#include <stdlib.h>
+#include "versions.h"
+
+int versionsInit(VersionedTopology* store, Graph* graph, int readerCount) {
+    TopologyVersion* version = (TopologyVersion*)malloc(sizeof(TopologyVersion));
+    store->readers = (ReaderSlot*)calloc(readerCount > 0 ? readerCount : 1, sizeof(ReaderSlot));
+    if (version == NULL || store->readers == NULL) {
+        free(version);
+        free(store->readers);
+        return -1;
+    }
+    version->graph = *graph;
+    version->number = 1;
+    version->retiredEpoch = 0;
+    version->next = NULL;
+    store->current = version;
+    store->epoch = 1;
+    store->readerCount = readerCount;
+    store->retired = NULL;
+    pthread_mutex_init(&store->writeLock, NULL);
+    return 0;
+}
+
+// Only call once every reader has stopped
+void versionsFree(VersionedTopology* store) {
+    while (store->retired != NULL) {
+        TopologyVersion* next = store->retired->next;
+        freeGraph(&store->retired->graph);
+        free(store->retired);
+        store->retired = next;
+    }
+    freeGraph(&store->current->graph);
+    free(store->current);
+    free(store->readers);
+    store->current = NULL;
+    store->readers = NULL;
+    pthread_mutex_destroy(&store->writeLock);
+}
+
+// Announce the epoch before loading the version: a writer that retires this
+// version afterwards sees the announcement and keeps it alive
+const TopologyVersion* versionsAcquire(VersionedTopology* store, int reader) {
+    unsigned long epoch = __atomic_load_n(&store->epoch, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&store->readers[reader].epoch, epoch, __ATOMIC_SEQ_CST);
+    return __atomic_load_n(&store->current, __ATOMIC_SEQ_CST);
+}
+
+void versionsRelease(VersionedTopology* store, int reader) {
+    __atomic_store_n(&store->readers[reader].epoch, VERSION_IDLE, __ATOMIC_RELEASE);
+}
+
+static int reclaimRetired(VersionedTopology* store);
+
+// Copy-on-write: the draft starts as a private copy of the current version
+Graph* versionsBeginUpdate(VersionedTopology* store) {
+    pthread_mutex_lock(&store->writeLock);
+    if (copyGraph(&store->draft, &store->current->graph) != 0) {
+        pthread_mutex_unlock(&store->writeLock);
+        return NULL;
+    }
+    return &store->draft;
+}
+
+void versionsAbort(VersionedTopology* store) {
+    freeGraph(&store->draft);
+    pthread_mutex_unlock(&store->writeLock);
+}
+
+int versionsPublish(VersionedTopology* store) {
+    TopologyVersion* version = (TopologyVersion*)malloc(sizeof(TopologyVersion));
+    if (version == NULL) {
+        versionsAbort(store);
+        return -1;
+    }
+    version->graph = store->draft;
+    version->number = store->current->number + 1;
+    version->retiredEpoch = 0;
+    version->next = NULL;
+
+    // Readers entering from here on load the new version; the old one waits
+    // until every reader that announced an epoch up to retiredEpoch has left
+    TopologyVersion* old = __atomic_exchange_n(&store->current, version, __ATOMIC_SEQ_CST);
+    old->retiredEpoch = __atomic_fetch_add(&store->epoch, 1, __ATOMIC_SEQ_CST);
+    old->next = store->retired;
+    store->retired = old;
+    reclaimRetired(store);
+    pthread_mutex_unlock(&store->writeLock);
+    return 0;
+}
+
+// Caller holds writeLock
+static int reclaimRetired(VersionedTopology* store) {
+    // Oldest epoch still announced by a reader
+    unsigned long oldest = ~0UL;
+    for (int r = 0; r < store->readerCount; r++) {
+        unsigned long epoch = __atomic_load_n(&store->readers[r].epoch, __ATOMIC_SEQ_CST);
+        if (epoch != VERSION_IDLE && epoch < oldest) oldest = epoch;
+    }
+
+    int remaining = 0;
+    TopologyVersion** link = &store->retired;
+    while (*link != NULL) {
+        TopologyVersion* version = *link;
+        if (version->retiredEpoch < oldest) {
+            *link = version->next;
+            freeGraph(&version->graph);
+            free(version);
+        } else {
+            link = &version->next;
+            remaining++;
+        }
+    }
+    return remaining;
+}
+
+int versionsReclaim(VersionedTopology* store) {
+    pthread_mutex_lock(&store->writeLock);
+    int remaining = reclaimRetired(store);
+    pthread_mutex_unlock(&store->writeLock);
+    return remaining;
+}
@@ -0,0 +1,50 @@
+#ifndef VERSIONS_H
+#define VERSIONS_H
+
+#include <pthread.h>
+#include "graph.h"
+
+#define VERSION_IDLE 0UL // Reader slot value outside a read section
+
+// One published, immutable topology
+typedef struct TopologyVersion {
+    Graph graph;                  // Never modified after publication
+    unsigned long number;         // 1 for the initial topology, +1 per publish
+    unsigned long retiredEpoch;   // Epoch in which a newer version replaced it
+    struct TopologyVersion* next; // Retired list link
+} TopologyVersion;
+
+// Epoch a reader announced on entry, padded to its own cache line
+typedef struct {
+    unsigned long epoch; // VERSION_IDLE when not reading
+    char padding[64 - sizeof(unsigned long)];
+} ReaderSlot;
+
+// Lock-free readers, one writer at a time building the next version copy-on-write
+typedef struct {
+    TopologyVersion* current;   // Atomic: the version new readers see
+    unsigned long epoch;        // Atomic: global epoch, starts at 1
+    ReaderSlot* readers;        // One slot per reader thread
+    int readerCount;
+    pthread_mutex_t writeLock;  // Held from versionsBeginUpdate to publish or abort
+    Graph draft;                // Writer's private copy of the current topology
+    TopologyVersion* retired;   // Replaced versions not yet reclaimed (writer side)
+} VersionedTopology;
+
+// Takes ownership of graph as version 1; readerCount fixes the number of reader slots
+int versionsInit(VersionedTopology* store, Graph* graph, int readerCount);
+void versionsFree(VersionedTopology* store);
+
+// Readers: bracket every use of the returned version; only const queries are allowed
+const TopologyVersion* versionsAcquire(VersionedTopology* store, int reader);
+void versionsRelease(VersionedTopology* store, int reader);
+
+// Writers: update the returned draft, then publish it atomically or drop it
+Graph* versionsBeginUpdate(VersionedTopology* store);
+int versionsPublish(VersionedTopology* store);
+void versionsAbort(VersionedTopology* store);
+
+// Free retired versions no reader can still hold; returns how many are left
+int versionsReclaim(VersionedTopology* store);
+
+#endif // VERSIONS_H
@@ -0,0 +1,191 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "alt.h"
+
+void landmarksInit(LandmarkSet* set) {
+    set->count = 0;
+    set->nodes = NULL;
+    set->distance = NULL;
+    set->nodeCount = 0;
+    set->version = 0;
+}
+
+void landmarksFree(LandmarkSet* set) {
+    free(set->nodes);
+    free(set->distance);
+    landmarksInit(set);
+}
+
+// Pick landmarks by farthest-point selection: each new landmark is the node farthest
+// from every landmark chosen so far, which spreads them around the edge of the
+// network where they give the tightest bounds. A node no landmark reaches counts as
+// infinitely far, so every component gets a landmark before any gets a second.
+int landmarksBuild(LandmarkSet* set, const Graph* graph, int count) {
+    landmarksFree(set);
+    if (!graph->finalized) return -1;
+    int n = graph->nodeCount;
+    if (count > n) count = n;
+    if (count <= 0) return 0;
+
+    SearchState state;
+    if (searchStateInit(&state, n, QUEUE_FOUR_ARY) != 0) return -1;
+    int* nearest = (int*)malloc(n * sizeof(int)); // Distance to the closest landmark so far
+    set->nodes = (int*)malloc(count * sizeof(int));
+    set->distance = (int*)malloc((size_t)n * count * sizeof(int));
+    int status = (nearest == NULL || set->nodes == NULL || set->distance == NULL) ? -1 : 0;
+
+    // The first landmark is the node farthest from node 0
+    if (status == 0) status = dijkstraSearch(graph, &state, 0, -1);
+    for (int v = 0; v < n && status == 0; v++) {
+        nearest[v] = searchDistance(&state, v);
+    }
+
+    for (int i = 0; i < count && status == 0; i++) {
+        int farthest = 0;
+        for (int v = 1; v < n; v++) {
+            if (nearest[v] > nearest[farthest]) farthest = v;
+        }
+        if (i > 0 && nearest[farthest] == 0) break; // Every node is already a landmark
+        if (dijkstraSearch(graph, &state, farthest, -1) != 0) {
+            status = -1;
+            break;
+        }
+        set->nodes[i] = farthest;
+        for (int v = 0; v < n; v++) {
+            int d = searchDistance(&state, v);
+            set->distance[(size_t)v * count + i] = d;
+            if (i == 0 || d < nearest[v]) nearest[v] = d;
+        }
+        set->count = i + 1;
+    }
+
+    // Compact the rows if selection stopped early
+    if (status == 0 && set->count < count) {
+        for (int v = 0; v < n; v++) {
+            for (int i = 0; i < set->count; i++) {
+                set->distance[(size_t)v * set->count + i] = set->distance[(size_t)v * count + i];
+            }
+        }
+    }
+    free(nearest);
+    searchStateFree(&state);
+    if (status != 0) {
+        landmarksFree(set);
+        return -1;
+    }
+    set->nodeCount = n;
+    set->version = graph->version;
+    return 0;
+}
+
+int landmarksValid(const LandmarkSet* set, const Graph* graph) {
+    return set->count > 0 && graph->finalized && set->nodeCount == graph->nodeCount &&
+           set->version >= graph->shortenedVersion;
+}
+
+// Lower bound on the travel time from v to the target: by the triangle inequality,
+// d(v, t) >= |d(L, v) - d(L, t)| for every landmark L
+static int lowerBound(const LandmarkSet* set, const int* active, int activeCount, int v, const int* toTarget) {
+    const int* row = set->distance + (size_t)v * set->count;
+    int bound = 0;
+    for (int k = 0; k < activeCount; k++) {
+        int fromLandmark = row[active[k]];
+        if (fromLandmark == UNREACHABLE || toTarget[k] == UNREACHABLE) continue;
+        int gap = fromLandmark - toTarget[k];
+        if (gap < 0) gap = -gap;
+        if (gap > bound) bound = gap;
+    }
+    return bound;
+}
+
+int altSearch(const Graph* graph, const LandmarkSet* landmarks, SearchState* state, int source, int target) {
+    if (landmarks == NULL || !landmarksValid(landmarks, graph)) {
+        return dijkstraSearch(graph, state, source, target);
+    }
+    if (target < 0 || searchStateReserve(state, graph->nodeCount) != 0) return -1;
+
+    // Consult only the landmarks that bound this source-target pair best
+    int active[ALT_ACTIVE_LANDMARKS];
+    int activeBound[ALT_ACTIVE_LANDMARKS];
+    int toTarget[ALT_ACTIVE_LANDMARKS];
+    int activeCount = 0;
+    const int* sourceRow = landmarks->distance + (size_t)source * landmarks->count;
+    const int* targetRow = landmarks->distance + (size_t)target * landmarks->count;
+    for (int i = 0; i < landmarks->count; i++) {
+        if (sourceRow[i] == UNREACHABLE || targetRow[i] == UNREACHABLE) continue;
+        int bound = sourceRow[i] > targetRow[i] ? sourceRow[i] - targetRow[i] : targetRow[i] - sourceRow[i];
+        int k = (activeCount < ALT_ACTIVE_LANDMARKS) ? activeCount++ : ALT_ACTIVE_LANDMARKS;
+        while (k > 0 && activeBound[k - 1] < bound) {
+            if (k < ALT_ACTIVE_LANDMARKS) {
+                active[k] = active[k - 1];
+                activeBound[k] = activeBound[k - 1];
+            }
+            k--;
+        }
+        if (k < ALT_ACTIVE_LANDMARKS) {
+            active[k] = i;
+            activeBound[k] = bound;
+        }
+    }
+    for (int k = 0; k < activeCount; k++) {
+        toTarget[k] = targetRow[active[k]];
+    }
+
+    // A*: queue keys are distance plus lower bound. The bound is consistent, so each
+    // node is still settled once, with its final distance.
+    searchReset(state);
+    searchRecord(state, source, 0, -1);
+    if (pqPush(&state->queue, source, lowerBound(landmarks, active, activeCount, source, toTarget)) != 0) return -1;
+
+    int key;
+    int node;
+    while ((node = pqPop(&state->queue, &key)) != -1) {
+        state->settled++;
+        if (node == target) break;
+
+        int distance = searchDistance(state, node);
+        for (int e = graph->offsets[node]; e < graph->offsets[node + 1]; e++) {
+            int next = graph->targets[e];
+            int candidate = distance + graph->weights[e];
+            if (candidate < searchDistance(state, next)) {
+                searchRecord(state, next, candidate, node);
+                int estimate = candidate + lowerBound(landmarks, active, activeCount, next, toTarget);
+                if (pqPush(&state->queue, next, estimate) != 0) return -1;
+            }
+        }
+    }
+    return searchDistance(state, target);
+}
+
+void altRoute(Graph* graph, const LandmarkSet* landmarks, const char* startNode, const char* endNode) {
+    int startIndex = findNode(graph, startNode);
+    int endIndex = findNode(graph, endNode);
+    if (startIndex == -1 || endIndex == -1) {
+        printf("Invalid start or end node.\n");
+        return;
+    }
+    if (finalizeGraph(graph) != 0) {
+        printf("Out of memory.\n");
+        return;
+    }
+
+    SearchState state;
+    if (searchStateInit(&state, graph->nodeCount, QUEUE_FOUR_ARY) != 0) {
+        printf("Out of memory.\n");
+        return;
+    }
+    int totalDistance = altSearch(graph, landmarks, &state, startIndex, endIndex);
+
+    if (totalDistance < 0) {
+        printf("Out of memory.\n");
+    } else if (totalDistance == UNREACHABLE) {
+        printf("No path found from %s to %s.\n", startNode, endNode);
+    } else {
+        printf("Shortest path from %s to %s:\n", startNode, endNode);
+        for (int at = endIndex; at != -1; at = searchPrevious(&state, at)) {
+            printf("%s ", graph->nodes[at].name);
+        }
+        printf("\nTotal travel time: %d\n", totalDistance);
+    }
+    searchStateFree(&state);
+}
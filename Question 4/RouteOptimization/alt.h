@@ -0,0 +1,38 @@
+#ifndef ALT_H
+#define ALT_H
+
+#include "graph.h"
+#include "search.h"
+
+#define ALT_DEFAULT_LANDMARKS 16 // Landmarks chosen by altRoute's caller when unsure
+#define ALT_ACTIVE_LANDMARKS 4   // Landmarks a query actually consults
+
+// Landmark distances for A* lower bounds (ALT: A*, landmarks, triangle inequality).
+// Roads run both ways, so one distance per landmark and node serves as both the
+// distance to and from the landmark.
+typedef struct {
+    int count;           // Landmarks selected
+    int* nodes;          // Landmark node indices
+    int* distance;       // distance[v * count + i]: travel time between v and landmark i
+    int nodeCount;       // Graph size the distances were computed for
+    unsigned int version; // Graph version they were computed at
+} LandmarkSet;
+
+void landmarksInit(LandmarkSet* set);
+int landmarksBuild(LandmarkSet* set, const Graph* graph, int count);
+void landmarksFree(LandmarkSet* set);
+
+// 1 if the set still gives valid bounds for this graph: it is not empty, no node was added
+// and no change since it was built could have shortened a route. Slower roads keep the
+// bounds valid (if looser), so live traffic that only adds delay does not disable ALT.
+int landmarksValid(const LandmarkSet* set, const Graph* graph);
+
+// A* from source to target with landmark lower bounds. Falls back to dijkstraSearch
+// when landmarks is NULL or not valid for the graph. Returns the travel time,
+// UNREACHABLE if there is no path, or -1 on error; the path is left in state.
+int altSearch(const Graph* graph, const LandmarkSet* landmarks, SearchState* state, int source, int target);
+
+// Print the route like dijkstra does
+void altRoute(Graph* graph, const LandmarkSet* landmarks, const char* startNode, const char* endNode);
+
+#endif // ALT_H
@@ -0,0 +1,353 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include "graph.h"
+#include "search.h"
+#include "ch.h"
+#include "alt.h"
+#include "deltastep.h"
+#include "isochrone.h"
+#include "network_io.h"
+
+// Routing benchmark on networks of realistic size.
+// Usage: ./RouteOptimizationBench [network] [queries] [seed]
+//   network: grid:SIDE (default grid:300), road:NODES, or a DIMACS .gr file; a .co file
+//            next to it is loaded too
+// The same random queries run through every routing mode. Results are CSV on stdout,
+// one row for loading the network and one per mode.
+
+#define DEFAULT_QUERIES 1000
+#define DEFAULT_GRID_SIDE 300
+#define GRID_MAX_WEIGHT 1000 // Grid travel times are uniform in 1..GRID_MAX_WEIGHT
+#define SWEEP_QUERIES 20     // Sources timed for the one-to-all modes
+#define ISOCHRONE_DIVISOR 4  // Isochrone budget: average query travel time divided by this
+
+typedef struct {
+    int* source;
+    int* target;
+    int* expected;  // Dijkstra's travel time, which every other mode must match
+    int count;
+} QuerySet;
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static long peakRssKb(void) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+static int randomNode(int n) {
+    return (int)(((size_t)rand() * RAND_MAX + rand()) % n);
+}
+
+static double mib(size_t bytes) {
+    return bytes / 1048576.0;
+}
+
+// Bytes of the routing arrays: CSR edges, node records and the name index
+static size_t graphBytes(const Graph* graph) {
+    return (size_t)(graph->nodeCount + 1) * sizeof(int) + 2 * (size_t)graph->edgeCount * sizeof(int) +
+           (size_t)graph->nodeCapacity * sizeof(Node) +
+           (size_t)graph->names.capacity * (sizeof(const char*) + sizeof(unsigned int)) +
+           (size_t)graph->names.slotCapacity * sizeof(int);
+}
+
+static size_t hierarchyBytes(const ContractionHierarchy* ch) {
+    return 2 * (size_t)(ch->nodeCount + 1) * sizeof(int) + 3 * (size_t)ch->arcCount * sizeof(int);
+}
+
+static void printRow(const char* mode, const Graph* graph, int queries, double prepMs, double prepMib,
+                     double seconds, long settled, int mismatches) {
+    printf("%s,%d,%d,%d,%.1f,%.2f,%.1f,%.1f,%d,%ld\n", mode, graph->nodeCount, graph->edgeCount, queries, prepMs,
+           prepMib, (queries && seconds > 0) ? queries / seconds : 0.0, queries ? (double)settled / queries : 0.0,
+           mismatches, peakRssKb());
+    fflush(stdout);
+}
+
+// Build the network named on the command line; returns 0 on success
+static int loadNetwork(Graph* graph, NodeCoordinates* coords, const char* spec) {
+    if (strncmp(spec, "grid:", 5) == 0) {
+        int side = atoi(spec + 5);
+        return generateGrid(graph, coords, side, side, GRID_MAX_WEIGHT, 1);
+    }
+    if (strncmp(spec, "road:", 5) == 0) {
+        return generateRoadNetwork(graph, coords, atoi(spec + 5), 1);
+    }
+    if (loadDimacsGraph(graph, spec) < 0) return -1;
+
+    size_t length = strlen(spec);
+    if (length > 3 && strcmp(spec + length - 3, ".gr") == 0) {
+        char* coordPath = strdup(spec);
+        if (coordPath == NULL) return -1;
+        coordPath[length - 1] = 'o';
+        coordPath[length - 2] = 'c';
+        int status = 0;
+        if (access(coordPath, R_OK) == 0) {
+            status = loadDimacsCoordinates(coords, coordPath, graph->nodeCount);
+        }
+        free(coordPath);
+        return status;
+    }
+    return 0;
+}
+
+// Point-to-point Dijkstra with either queue; the 4-ary run also records the reference times
+static void runDijkstra(const Graph* graph, QuerySet* queries, QueueKind kind, const char* mode) {
+    SearchState state;
+    if (searchStateInit(&state, graph->nodeCount, kind) != 0) return;
+    long settled = 0;
+    int mismatches = 0;
+    double start = nowSeconds();
+    for (int q = 0; q < queries->count; q++) {
+        int distance = dijkstraSearch(graph, &state, queries->source[q], queries->target[q]);
+        settled += state.settled;
+        if (kind == QUEUE_FOUR_ARY) {
+            queries->expected[q] = distance;
+        } else if (distance != queries->expected[q]) {
+            mismatches++;
+        }
+    }
+    printRow(mode, graph, queries->count, 0.0, 0.0, nowSeconds() - start, settled, mismatches);
+    searchStateFree(&state);
+}
+
+static void runBidirectional(const Graph* graph, const QuerySet* queries) {
+    SearchState forward;
+    SearchState backward;
+    if (searchStateInit(&forward, graph->nodeCount, QUEUE_FOUR_ARY) != 0) return;
+    if (searchStateInit(&backward, graph->nodeCount, QUEUE_FOUR_ARY) != 0) {
+        searchStateFree(&forward);
+        return;
+    }
+    long settled = 0;
+    int mismatches = 0;
+    double start = nowSeconds();
+    for (int q = 0; q < queries->count; q++) {
+        int meeting;
+        int distance = bidirectionalSearch(graph, &forward, &backward, queries->source[q], queries->target[q],
+                                           &meeting);
+        settled += forward.settled + backward.settled;
+        if (distance != queries->expected[q]) mismatches++;
+    }
+    printRow("bidirectional", graph, queries->count, 0.0, 0.0, nowSeconds() - start, settled, mismatches);
+    searchStateFree(&forward);
+    searchStateFree(&backward);
+}
+
+static void runAlt(const Graph* graph, const QuerySet* queries) {
+    LandmarkSet landmarks;
+    landmarksInit(&landmarks);
+    SearchState state;
+    double start = nowSeconds();
+    if (landmarksBuild(&landmarks, graph, ALT_DEFAULT_LANDMARKS) != 0) {
+        fprintf(stderr, "Could not build landmarks\n");
+        return;
+    }
+    double prepMs = (nowSeconds() - start) * 1e3;
+    double prepMib = mib((size_t)landmarks.count * graph->nodeCount * sizeof(int));
+    if (searchStateInit(&state, graph->nodeCount, QUEUE_FOUR_ARY) == 0) {
+        long settled = 0;
+        int mismatches = 0;
+        start = nowSeconds();
+        for (int q = 0; q < queries->count; q++) {
+            int distance = altSearch(graph, &landmarks, &state, queries->source[q], queries->target[q]);
+            settled += state.settled;
+            if (distance != queries->expected[q]) mismatches++;
+        }
+        printRow("alt", graph, queries->count, prepMs, prepMib, nowSeconds() - start, settled, mismatches);
+        searchStateFree(&state);
+    }
+    landmarksFree(&landmarks);
+}
+
+static void runHierarchy(const Graph* graph, const QuerySet* queries) {
+    ContractionHierarchy ch;
+    ChQuery query;
+    double start = nowSeconds();
+    if (chBuild(&ch, graph) != 0) {
+        fprintf(stderr, "Could not build the contraction hierarchy\n");
+        return;
+    }
+    double prepMs = (nowSeconds() - start) * 1e3;
+    if (chQueryInit(&query, graph->nodeCount) == 0) {
+        long settled = 0;
+        int mismatches = 0;
+        start = nowSeconds();
+        for (int q = 0; q < queries->count; q++) {
+            int distance = chQuery(&ch, &query, queries->source[q], queries->target[q]);
+            settled += query.settled;
+            if (distance != queries->expected[q]) mismatches++;
+        }
+        printRow("ch", graph, queries->count, prepMs, mib(hierarchyBytes(&ch)), nowSeconds() - start, settled,
+                 mismatches);
+        chQueryFree(&query);
+    }
+    chFree(&ch);
+}
+
+// Check a delta-stepping result against Dijkstra's from the same source: every distance
+// must match, and every predecessor p of v must have a road p -> v with
+// distance[p] + weight == distance[v]. Returns 0 if the whole result agrees, else 1.
+static int sweepMismatch(const Graph* graph, const SearchState* state, const DeltaStepper* stepper, int source) {
+    for (int v = 0; v < graph->nodeCount; v++) {
+        int distance = stepper->distance[v];
+        if (distance != searchDistance(state, v)) return 1;
+        int p = stepper->previous[v];
+        if (v == source || distance == UNREACHABLE) {
+            if (p != -1) return 1;
+            continue;
+        }
+        if (p < 0 || p >= graph->nodeCount || stepper->distance[p] == UNREACHABLE) return 1;
+        int found = 0;
+        for (int e = graph->offsets[p]; e < graph->offsets[p + 1] && !found; e++) {
+            found = graph->targets[e] == v && stepper->distance[p] + graph->weights[e] == distance;
+        }
+        if (!found) return 1;
+    }
+    return 0;
+}
+
+// One-to-all searches from the first sources. Each source runs through Dijkstra and then
+// delta-stepping, timed apart, and the delta-stepping result is checked against the
+// Dijkstra one still in the search state.
+static void runSweeps(const Graph* graph, const QuerySet* queries) {
+    int sweeps = (queries->count < SWEEP_QUERIES) ? queries->count : SWEEP_QUERIES;
+    SearchState state;
+    DeltaStepper stepper;
+    if (searchStateInit(&state, graph->nodeCount, QUEUE_FOUR_ARY) != 0) return;
+    if (deltaStepperInit(&stepper, 0) != 0) {
+        searchStateFree(&state);
+        return;
+    }
+    long dijkstraSettled = 0;
+    long deltaSettled = 0;
+    double dijkstraSeconds = 0.0;
+    double deltaSeconds = 0.0;
+    int mismatches = 0;
+    for (int q = 0; q < sweeps; q++) {
+        int source = queries->source[q];
+        double start = nowSeconds();
+        dijkstraSearch(graph, &state, source, -1);
+        dijkstraSeconds += nowSeconds() - start;
+        dijkstraSettled += state.settled;
+
+        start = nowSeconds();
+        int failed = deltaSteppingSearch(&stepper, graph, source, 0) != 0;
+        deltaSeconds += nowSeconds() - start;
+        if (failed) {
+            mismatches++;
+            continue;
+        }
+        for (int v = 0; v < graph->nodeCount; v++) {
+            if (stepper.distance[v] != UNREACHABLE) deltaSettled++;
+        }
+        mismatches += sweepMismatch(graph, &state, &stepper, source);
+    }
+    printRow("dijkstra_all", graph, sweeps, 0.0, 0.0, dijkstraSeconds, dijkstraSettled, 0);
+    printRow("delta_stepping_all", graph, sweeps, 0.0, 0.0, deltaSeconds, deltaSettled, mismatches);
+    deltaStepperFree(&stepper);
+    searchStateFree(&state);
+}
+
+// Coverage maps from every query source, batched across the workers
+static void runIsochrones(const Graph* graph, const QuerySet* queries) {
+    long long total = 0;
+    int reachable = 0;
+    for (int q = 0; q < queries->count; q++) {
+        if (queries->expected[q] == UNREACHABLE) continue;
+        total += queries->expected[q];
+        reachable++;
+    }
+    int budget = reachable ? (int)(total / reachable / ISOCHRONE_DIVISOR) : 0;
+
+    Dispatcher dispatcher;
+    Isochrone* results = (Isochrone*)malloc(queries->count * sizeof(Isochrone));
+    if (results == NULL || dispatcherInit(&dispatcher, 0) != 0) {
+        free(results);
+        return;
+    }
+    for (int q = 0; q < queries->count; q++) {
+        isochroneInit(&results[q]);
+    }
+    double start = nowSeconds();
+    int status = isochroneBatch(&dispatcher, graph, queries->source, queries->count, budget, results);
+    double seconds = nowSeconds() - start;
+    long settled = 0;
+    int mismatches = (status == 0) ? 0 : queries->count;
+    for (int q = 0; q < queries->count; q++) {
+        settled += results[q].count;
+        // The target must be inside exactly when its travel time fits the budget
+        int inside = 0;
+        for (int i = 0; i < results[q].count && !inside; i++) {
+            inside = results[q].nodes[i] == queries->target[q] && results[q].times[i] == queries->expected[q];
+        }
+        if (inside != (queries->expected[q] <= budget)) mismatches++;
+        isochroneFree(&results[q]);
+    }
+    printRow("isochrone", graph, queries->count, 0.0, 0.0, seconds, settled, mismatches);
+    dispatcherFree(&dispatcher);
+    free(results);
+}
+
+int main(int argc, char* argv[]) {
+    char defaultSpec[32];
+    snprintf(defaultSpec, sizeof(defaultSpec), "grid:%d", DEFAULT_GRID_SIDE);
+    const char* spec = (argc > 1) ? argv[1] : defaultSpec;
+    int queryCount = (argc > 2) ? atoi(argv[2]) : DEFAULT_QUERIES;
+    unsigned seed = (argc > 3) ? (unsigned)strtoul(argv[3], NULL, 10) : 42;
+    srand(seed);
+
+    Graph graph;
+    NodeCoordinates coords;
+    initializeGraph(&graph);
+    coordinatesInit(&coords);
+    double start = nowSeconds();
+    if (loadNetwork(&graph, &coords, spec) != 0 || graph.nodeCount == 0) {
+        fprintf(stderr, "Could not load network %s\n", spec);
+        freeGraph(&graph);
+        coordinatesFree(&coords);
+        return 1;
+    }
+    double loadMs = (nowSeconds() - start) * 1e3;
+
+    QuerySet queries;
+    queries.count = (queryCount > 0) ? queryCount : 1;
+    queries.source = (int*)malloc(queries.count * sizeof(int));
+    queries.target = (int*)malloc(queries.count * sizeof(int));
+    queries.expected = (int*)malloc(queries.count * sizeof(int));
+    if (queries.source == NULL || queries.target == NULL || queries.expected == NULL) {
+        fprintf(stderr, "Could not allocate %d queries\n", queries.count);
+        return 1;
+    }
+    for (int q = 0; q < queries.count; q++) {
+        queries.source[q] = randomNode(graph.nodeCount);
+        queries.target[q] = randomNode(graph.nodeCount);
+    }
+
+    // prep=ms and MiB of preprocessing (of the network itself for "load"), rss=KiB
+    printf("mode,nodes,edges,queries,prep_ms,prep_mib,queries_per_sec,settled_per_query,mismatches,rss_kib\n");
+    printRow("load", &graph, 0, loadMs, mib(graphBytes(&graph)), 0.0, 0, 0);
+    runDijkstra(&graph, &queries, QUEUE_FOUR_ARY, "dijkstra");
+    runDijkstra(&graph, &queries, QUEUE_RADIX, "dijkstra_radix");
+    runBidirectional(&graph, &queries);
+    runAlt(&graph, &queries);
+    runHierarchy(&graph, &queries);
+    runSweeps(&graph, &queries);
+    runIsochrones(&graph, &queries);
+
+    free(queries.source);
+    free(queries.target);
+    free(queries.expected);
+    coordinatesFree(&coords);
+    freeGraph(&graph);
+    return 0;
+}
@@ -0,0 +1,663 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ch.h"
+
+// ---- Preprocessing ----
+
+typedef struct {
+    int target;
+    int weight;
+    int middle;
+} ChArc;
+
+// Arcs of one node while the hierarchy is being built
+typedef struct {
+    ChArc* arcs;
+    int count;
+    int capacity;
+} ChArcList;
+
+typedef struct {
+    ChArcList* lists;       // Remaining arcs per node; frozen once the node is contracted
+    int* deletedNeighbors;  // Contracted neighbors, a tie-breaker that spreads contraction evenly
+    SearchState witness;    // Reused by every witness search
+    unsigned int* targetMark; // Nodes a witness search still has to settle carry the current mark
+    unsigned int mark;
+    int* shortcutFrom;      // Shortcuts found while contracting one node
+    int* shortcutTo;
+    int* shortcutWeight;
+    int shortcutCapacity;
+} Contractor;
+
+// Add or shorten the arc to target; returns -1 if memory runs out
+static int arcAdd(ChArcList* list, int target, int weight, int middle) {
+    for (int i = 0; i < list->count; i++) {
+        if (list->arcs[i].target == target) {
+            if (weight < list->arcs[i].weight) {
+                list->arcs[i].weight = weight;
+                list->arcs[i].middle = middle;
+            }
+            return 0;
+        }
+    }
+    if (list->count == list->capacity) {
+        int capacity = list->capacity ? list->capacity * 2 : 4;
+        ChArc* arcs = (ChArc*)realloc(list->arcs, capacity * sizeof(ChArc));
+        if (arcs == NULL) return -1;
+        list->arcs = arcs;
+        list->capacity = capacity;
+    }
+    list->arcs[list->count].target = target;
+    list->arcs[list->count].weight = weight;
+    list->arcs[list->count].middle = middle;
+    list->count++;
+    return 0;
+}
+
+static void arcRemove(ChArcList* list, int target) {
+    for (int i = 0; i < list->count; i++) {
+        if (list->arcs[i].target == target) {
+            list->arcs[i] = list->arcs[--list->count];
+            return;
+        }
+    }
+}
+
+// Dijkstra from source over the remaining graph, never entering skip. It stops once the
+// targets marked with the current mark are settled, beyond maxDistance, or after limit
+// settled nodes. Distances land in contractor->witness.
+static int witnessSearch(Contractor* contractor, int source, int skip, int targets, int maxDistance, int limit) {
+    SearchState* state = &contractor->witness;
+    searchReset(state);
+    searchRecord(state, source, 0, -1);
+    if (pqPush(&state->queue, source, 0) != 0) return -1;
+    int distance;
+    int node;
+    while (targets > 0 && (node = pqPop(&state->queue, &distance)) != -1) {
+        if (distance > maxDistance || ++state->settled > limit) break;
+        if (contractor->targetMark[node] == contractor->mark) targets--;
+        const ChArcList* list = &contractor->lists[node];
+        for (int i = 0; i < list->count; i++) {
+            int next = list->arcs[i].target;
+            int candidate = distance + list->arcs[i].weight;
+            if (next == skip || candidate >= searchDistance(state, next)) continue;
+            searchRecord(state, next, candidate, node);
+            if (pqPush(&state->queue, next, candidate) != 0) return -1;
+        }
+    }
+    return 0;
+}
+
+// Shortcuts needed to contract v: a pair of neighbors u, w gets one unless a witness
+// path avoiding v is no longer than u - v - w. Returns the count, or -1 on error.
+static int findShortcuts(Contractor* contractor, int v, int limit) {
+    const ChArcList* list = &contractor->lists[v];
+    int found = 0;
+    for (int i = 0; i + 1 < list->count; i++) {
+        int u = list->arcs[i].target;
+        int viaU = list->arcs[i].weight;
+
+        // Each pair is checked once, from its earlier neighbor
+        int maxOut = 0;
+        if (++contractor->mark == 0) {
+            memset(contractor->targetMark, 0, contractor->witness.capacity * sizeof(unsigned int));
+            contractor->mark = 1;
+        }
+        for (int j = i + 1; j < list->count; j++) {
+            contractor->targetMark[list->arcs[j].target] = contractor->mark;
+            if (list->arcs[j].weight > maxOut) maxOut = list->arcs[j].weight;
+        }
+        if (witnessSearch(contractor, u, v, list->count - i - 1, viaU + maxOut, limit) != 0) return -1;
+        for (int j = i + 1; j < list->count; j++) {
+            int w = list->arcs[j].target;
+            int via = viaU + list->arcs[j].weight;
+            if (searchDistance(&contractor->witness, w) <= via) continue;
+            if (found == contractor->shortcutCapacity) {
+                int capacity = contractor->shortcutCapacity ? contractor->shortcutCapacity * 2 : 64;
+                int* from = (int*)realloc(contractor->shortcutFrom, capacity * sizeof(int));
+                if (from == NULL) return -1;
+                contractor->shortcutFrom = from;
+                int* to = (int*)realloc(contractor->shortcutTo, capacity * sizeof(int));
+                if (to == NULL) return -1;
+                contractor->shortcutTo = to;
+                int* weight = (int*)realloc(contractor->shortcutWeight, capacity * sizeof(int));
+                if (weight == NULL) return -1;
+                contractor->shortcutWeight = weight;
+                contractor->shortcutCapacity = capacity;
+            }
+            contractor->shortcutFrom[found] = u;
+            contractor->shortcutTo[found] = w;
+            contractor->shortcutWeight[found] = via;
+            found++;
+        }
+    }
+    return found;
+}
+
+// Edge difference plus contracted neighbors: nodes whose removal adds few shortcuts go first
+static int contractionPriority(Contractor* contractor, int v, int* priority) {
+    int shortcuts = findShortcuts(contractor, v, CH_PRIORITY_SETTLE_LIMIT);
+    if (shortcuts < 0) return -1;
+    *priority = 2 * (shortcuts - contractor->lists[v].count) + contractor->deletedNeighbors[v];
+    return 0;
+}
+
+static void contractorFree(Contractor* contractor, int nodeCount) {
+    if (contractor->lists != NULL) {
+        for (int v = 0; v < nodeCount; v++) free(contractor->lists[v].arcs);
+    }
+    free(contractor->lists);
+    free(contractor->deletedNeighbors);
+    free(contractor->targetMark);
+    free(contractor->shortcutFrom);
+    free(contractor->shortcutTo);
+    free(contractor->shortcutWeight);
+    searchStateFree(&contractor->witness);
+}
+
+// Lay the frozen arc lists out as the hierarchy's upward CSR arrays
+static int buildUpwardArrays(ContractionHierarchy* ch, const Contractor* contractor) {
+    int n = ch->nodeCount;
+    ch->offsets = (int*)malloc((n + 1) * sizeof(int));
+    if (ch->offsets == NULL) return -1;
+    ch->offsets[0] = 0;
+    for (int v = 0; v < n; v++) {
+        ch->offsets[v + 1] = ch->offsets[v] + contractor->lists[v].count;
+    }
+    ch->arcCount = ch->offsets[n];
+    ch->targets = (int*)malloc((ch->arcCount + 1) * sizeof(int));
+    ch->weights = (int*)malloc((ch->arcCount + 1) * sizeof(int));
+    ch->middle = (int*)malloc((ch->arcCount + 1) * sizeof(int));
+    if (ch->targets == NULL || ch->weights == NULL || ch->middle == NULL) return -1;
+    ch->shortcutCount = 0;
+    for (int v = 0; v < n; v++) {
+        const ChArcList* list = &contractor->lists[v];
+        for (int i = 0; i < list->count; i++) {
+            int at = ch->offsets[v] + i;
+            ch->targets[at] = list->arcs[i].target;
+            ch->weights[at] = list->arcs[i].weight;
+            ch->middle[at] = list->arcs[i].middle;
+            if (list->arcs[i].middle != -1) ch->shortcutCount++;
+        }
+    }
+    return 0;
+}
+
+static void chClear(ContractionHierarchy* ch) {
+    ch->nodeCount = 0;
+    ch->graphEdgeCount = 0;
+    ch->version = 0;
+    ch->graphChecksum = 0;
+    ch->rank = NULL;
+    ch->offsets = NULL;
+    ch->targets = NULL;
+    ch->weights = NULL;
+    ch->middle = NULL;
+    ch->arcCount = 0;
+    ch->shortcutCount = 0;
+}
+
+// Contract every node in order of priority, adding the shortcuts that keep
+// distances among the remaining nodes intact. Returns 0, or -1 on error.
+int chBuild(ContractionHierarchy* ch, const Graph* graph) {
+    chClear(ch);
+    if (!graph->finalized) return -1;
+    int n = graph->nodeCount;
+    ch->nodeCount = n;
+    ch->graphEdgeCount = graph->edgeCount;
+    ch->version = graph->version;
+    ch->graphChecksum = chGraphChecksum(graph);
+
+    Contractor contractor;
+    memset(&contractor, 0, sizeof(contractor));
+    PriorityQueue order;
+    int status = pqInit(&order, QUEUE_FOUR_ARY, n);
+    contractor.lists = (ChArcList*)calloc(n + 1, sizeof(ChArcList));
+    contractor.deletedNeighbors = (int*)calloc(n + 1, sizeof(int));
+    contractor.targetMark = (unsigned int*)calloc(n + 1, sizeof(unsigned int));
+    ch->rank = (int*)malloc((n + 1) * sizeof(int));
+    if (status != 0 || searchStateInit(&contractor.witness, n, QUEUE_FOUR_ARY) != 0 ||
+        contractor.lists == NULL || contractor.deletedNeighbors == NULL || contractor.targetMark == NULL ||
+        ch->rank == NULL) {
+        status = -1;
+    }
+
+    // Parallel roads collapse into the shortest one; self-loops never help
+    for (int v = 0; v < n && status == 0; v++) {
+        for (int e = graph->offsets[v]; e < graph->offsets[v + 1] && status == 0; e++) {
+            if (graph->targets[e] != v) status = arcAdd(&contractor.lists[v], graph->targets[e], graph->weights[e], -1);
+        }
+    }
+    for (int v = 0; v < n && status == 0; v++) {
+        int priority;
+        if (contractionPriority(&contractor, v, &priority) != 0 || pqPush(&order, v, priority) != 0) status = -1;
+    }
+
+    int nextRank = 0;
+    int key;
+    int v;
+    while (status == 0 && (v = pqPop(&order, &key)) != -1) {
+        // Lazy update: neighbors' contractions may have made v more expensive
+        int priority;
+        int best;
+        if (contractionPriority(&contractor, v, &priority) != 0) {
+            status = -1;
+            break;
+        }
+        if (pqPeek(&order, &best) != -1 && priority > best) {
+            if (pqPush(&order, v, priority) != 0) status = -1;
+            continue;
+        }
+
+        int shortcuts = findShortcuts(&contractor, v, CH_WITNESS_SETTLE_LIMIT);
+        if (shortcuts < 0) {
+            status = -1;
+            break;
+        }
+        for (int s = 0; s < shortcuts && status == 0; s++) {
+            int u = contractor.shortcutFrom[s];
+            int w = contractor.shortcutTo[s];
+            int weight = contractor.shortcutWeight[s];
+            if (arcAdd(&contractor.lists[u], w, weight, v) != 0 || arcAdd(&contractor.lists[w], u, weight, v) != 0) {
+                status = -1;
+            }
+        }
+        // v's remaining arcs become its upward arcs; detach it from its neighbors
+        const ChArcList* list = &contractor.lists[v];
+        for (int i = 0; i < list->count; i++) {
+            arcRemove(&contractor.lists[list->arcs[i].target], v);
+            contractor.deletedNeighbors[list->arcs[i].target]++;
+        }
+        ch->rank[v] = nextRank++;
+    }
+
+    if (status == 0) status = buildUpwardArrays(ch, &contractor);
+    contractorFree(&contractor, n);
+    pqFree(&order);
+    if (status != 0) {
+        chFree(ch);
+        return -1;
+    }
+    return 0;
+}
+
+void chFree(ContractionHierarchy* ch) {
+    free(ch->rank);
+    free(ch->offsets);
+    free(ch->targets);
+    free(ch->weights);
+    free(ch->middle);
+    chClear(ch);
+}
+
+// ---- Serialized format ----
+// Magic, then CH_BYTE_ORDER and sizeof(int) as unsigned int, nodeCount, graphEdgeCount,
+// arcCount, shortcutCount as int, the graph checksum as unsigned long long,
+// then rank[nodeCount], offsets[nodeCount + 1], targets, weights, middle[arcCount].
+
+static unsigned long long fnvAdd(unsigned long long hash, const int* values, int count) {
+    const unsigned char* bytes = (const unsigned char*)values;
+    size_t length = (size_t)count * sizeof(int);
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+unsigned long long chGraphChecksum(const Graph* graph) {
+    unsigned long long hash = 14695981039346656037ULL;
+    hash = fnvAdd(hash, &graph->nodeCount, 1);
+    hash = fnvAdd(hash, graph->offsets, graph->nodeCount + 1);
+    hash = fnvAdd(hash, graph->targets, graph->edgeCount);
+    return fnvAdd(hash, graph->weights, graph->edgeCount);
+}
+
+int chSave(const ContractionHierarchy* ch, const char* path) {
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        perror("Could not create hierarchy file");
+        return -1;
+    }
+    unsigned int format[2] = { CH_BYTE_ORDER, (unsigned int)sizeof(int) };
+    int header[4] = { ch->nodeCount, ch->graphEdgeCount, ch->arcCount, ch->shortcutCount };
+    int ok = fwrite(CH_FILE_MAGIC, 1, 8, file) == 8 &&
+             fwrite(format, sizeof(unsigned int), 2, file) == 2 &&
+             fwrite(header, sizeof(int), 4, file) == 4 &&
+             fwrite(&ch->graphChecksum, sizeof(ch->graphChecksum), 1, file) == 1 &&
+             fwrite(ch->rank, sizeof(int), ch->nodeCount, file) == (size_t)ch->nodeCount &&
+             fwrite(ch->offsets, sizeof(int), ch->nodeCount + 1, file) == (size_t)ch->nodeCount + 1 &&
+             fwrite(ch->targets, sizeof(int), ch->arcCount, file) == (size_t)ch->arcCount &&
+             fwrite(ch->weights, sizeof(int), ch->arcCount, file) == (size_t)ch->arcCount &&
+             fwrite(ch->middle, sizeof(int), ch->arcCount, file) == (size_t)ch->arcCount;
+    if (fclose(file) != 0) ok = 0;
+    if (!ok) {
+        fprintf(stderr, "Could not write %s\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+// Check what queries and chPath rely on: ranks form a permutation, offsets and targets
+// stay in range, every arc leads to a higher rank, and a shortcut's middle ranks below
+// both ends, so unpacking always descends and ends. Returns 1 if valid, 0 if not, -1 on OOM.
+static int validHierarchy(const ContractionHierarchy* ch) {
+    int n = ch->nodeCount;
+    char* seen = (char*)calloc(n + 1, 1);
+    if (seen == NULL) return -1;
+    int ok = 1;
+    for (int v = 0; v < n && ok; v++) {
+        int r = ch->rank[v];
+        ok = r >= 0 && r < n && !seen[r];
+        if (ok) seen[r] = 1;
+    }
+    free(seen);
+    ok = ok && ch->offsets[0] == 0 && ch->offsets[n] == ch->arcCount;
+    for (int v = 0; v < n && ok; v++) {
+        ok = ch->offsets[v] <= ch->offsets[v + 1];
+    }
+    int shortcuts = 0;
+    for (int v = 0; v < n && ok; v++) {
+        for (int a = ch->offsets[v]; a < ch->offsets[v + 1] && ok; a++) {
+            int target = ch->targets[a];
+            int middle = ch->middle[a];
+            ok = target >= 0 && target < n && ch->rank[target] > ch->rank[v] && ch->weights[a] >= 0 &&
+                 middle >= -1 && middle < n;
+            if (ok && middle != -1) {
+                ok = ch->rank[middle] < ch->rank[v];
+                shortcuts++;
+            }
+        }
+    }
+    return ok && shortcuts == ch->shortcutCount;
+}
+
+int chLoad(ContractionHierarchy* ch, const char* path, const Graph* graph) {
+    chClear(ch);
+    if (!graph->finalized) return -1;
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        perror("Could not open hierarchy file");
+        return -1;
+    }
+    char magic[8];
+    unsigned int format[2];
+    int header[4];
+    const char* problem = NULL;
+    if (fread(magic, 1, 8, file) != 8 || memcmp(magic, CH_FILE_MAGIC, 8) != 0 ||
+        fread(format, sizeof(unsigned int), 2, file) != 2) {
+        problem = "is not a hierarchy file";
+    } else if (format[0] != CH_BYTE_ORDER || format[1] != sizeof(int)) {
+        problem = "was saved on a machine with a different byte order or int width";
+    } else if (fread(header, sizeof(int), 4, file) != 4 ||
+               fread(&ch->graphChecksum, sizeof(ch->graphChecksum), 1, file) != 1) {
+        problem = "is truncated";
+    } else if (header[0] != graph->nodeCount || header[1] != graph->edgeCount ||
+               ch->graphChecksum != chGraphChecksum(graph)) {
+        problem = "was built for other roads or travel times; rebuild it";
+    } else if (header[2] < 0 || header[3] < 0 || header[3] > header[2]) {
+        problem = "has a corrupt header";
+    }
+    if (problem == NULL) {
+        ch->nodeCount = header[0];
+        ch->graphEdgeCount = header[1];
+        ch->arcCount = header[2];
+        ch->shortcutCount = header[3];
+        int n = ch->nodeCount;
+        ch->rank = (int*)malloc((n + 1) * sizeof(int));
+        ch->offsets = (int*)malloc((n + 1) * sizeof(int));
+        ch->targets = (int*)malloc((ch->arcCount + 1) * sizeof(int));
+        ch->weights = (int*)malloc((ch->arcCount + 1) * sizeof(int));
+        ch->middle = (int*)malloc((ch->arcCount + 1) * sizeof(int));
+        int valid = -1;
+        if (ch->rank && ch->offsets && ch->targets && ch->weights && ch->middle) {
+            valid = fread(ch->rank, sizeof(int), n, file) == (size_t)n &&
+                    fread(ch->offsets, sizeof(int), n + 1, file) == (size_t)n + 1 &&
+                    fread(ch->targets, sizeof(int), ch->arcCount, file) == (size_t)ch->arcCount &&
+                    fread(ch->weights, sizeof(int), ch->arcCount, file) == (size_t)ch->arcCount &&
+                    fread(ch->middle, sizeof(int), ch->arcCount, file) == (size_t)ch->arcCount;
+            if (!valid) {
+                problem = "is truncated";
+            } else {
+                valid = validHierarchy(ch);
+                if (valid == 0) problem = "is not a valid hierarchy";
+            }
+        }
+        if (valid == -1) problem = "could not be loaded: out of memory";
+    }
+    fclose(file);
+    if (problem != NULL) {
+        fprintf(stderr, "%s %s\n", path, problem);
+        chFree(ch);
+        return -1;
+    }
+    ch->version = graph->version;
+    return 0;
+}
+
+// ---- Queries ----
+
+int chQueryInit(ChQuery* query, int capacity) {
+    query->meeting = -1;
+    query->settled = 0;
+    if (searchStateInit(&query->forward, capacity, QUEUE_FOUR_ARY) != 0) return -1;
+    if (searchStateInit(&query->backward, capacity, QUEUE_FOUR_ARY) != 0) {
+        searchStateFree(&query->forward);
+        return -1;
+    }
+    return 0;
+}
+
+void chQueryFree(ChQuery* query) {
+    searchStateFree(&query->forward);
+    searchStateFree(&query->backward);
+}
+
+// Stall on demand: roads are symmetric, so the upward arcs double as arcs coming down
+// from higher nodes. If one of those already offers a shorter way here, the node is
+// not on a shortest upward path and its arcs need not be relaxed.
+static int isStalled(const ContractionHierarchy* ch, const SearchState* state, int node, int distance) {
+    for (int a = ch->offsets[node]; a < ch->offsets[node + 1]; a++) {
+        int above = searchDistance(state, ch->targets[a]);
+        if (above != UNREACHABLE && above + ch->weights[a] < distance) return 1;
+    }
+    return 0;
+}
+
+static int relaxUpward(const ContractionHierarchy* ch, SearchState* state, int node, int distance) {
+    for (int a = ch->offsets[node]; a < ch->offsets[node + 1]; a++) {
+        int next = ch->targets[a];
+        int candidate = distance + ch->weights[a];
+        if (candidate < searchDistance(state, next)) {
+            searchRecord(state, next, candidate, node);
+            if (pqPush(&state->queue, next, candidate) != 0) return -1;
+        }
+    }
+    return 0;
+}
+
+// Settle one node of an upward search and check it against the other direction.
+// Returns 0 while the direction should continue, 1 once it is done, -1 on error.
+static int upwardStep(const ContractionHierarchy* ch, SearchState* state, const SearchState* other,
+                      int* best, int* meeting) {
+    int distance;
+    int node = pqPop(&state->queue, &distance);
+    if (node == -1 || distance >= *best) return 1; // Nothing left that could improve the route
+    state->settled++;
+    int opposite = searchDistance(other, node);
+    if (opposite != UNREACHABLE && distance + opposite < *best) {
+        *best = distance + opposite;
+        *meeting = node;
+    }
+    if (isStalled(ch, state, node, distance)) return 0;
+    return relaxUpward(ch, state, node, distance);
+}
+
+// Complete upward search from source, reporting every node it settles without
+// stalling. Any route from source climbs to its highest node through one of them.
+int chUpwardSearch(const ContractionHierarchy* ch, SearchState* state, int source, ChVisit visit, void* context) {
+    if (source < 0 || source >= ch->nodeCount) return -1;
+    if (searchStateReserve(state, ch->nodeCount) != 0) return -1;
+    searchReset(state);
+    searchRecord(state, source, 0, -1);
+    if (pqPush(&state->queue, source, 0) != 0) return -1;
+
+    int distance;
+    int node;
+    while ((node = pqPop(&state->queue, &distance)) != -1) {
+        state->settled++;
+        if (isStalled(ch, state, node, distance)) continue;
+        visit(context, node, distance);
+        if (relaxUpward(ch, state, node, distance) != 0) return -1;
+    }
+    return 0;
+}
+
+// Bidirectional search that only climbs: the forward search from source and the
+// backward search from target each follow upward arcs, and meet at the top of the route
+int chQuery(const ContractionHierarchy* ch, ChQuery* query, int source, int target) {
+    if (source < 0 || source >= ch->nodeCount || target < 0 || target >= ch->nodeCount) return -1;
+    if (searchStateReserve(&query->forward, ch->nodeCount) != 0 ||
+        searchStateReserve(&query->backward, ch->nodeCount) != 0) {
+        return -1;
+    }
+    SearchState* forward = &query->forward;
+    SearchState* backward = &query->backward;
+    searchReset(forward);
+    searchReset(backward);
+    searchRecord(forward, source, 0, -1);
+    searchRecord(backward, target, 0, -1);
+    if (pqPush(&forward->queue, source, 0) != 0 || pqPush(&backward->queue, target, 0) != 0) return -1;
+
+    int best = UNREACHABLE;
+    query->meeting = -1;
+    int forwardDone = 0;
+    int backwardDone = 0;
+    while (!forwardDone || !backwardDone) {
+        if (!forwardDone) forwardDone = upwardStep(ch, forward, backward, &best, &query->meeting);
+        if (!backwardDone) backwardDone = upwardStep(ch, backward, forward, &best, &query->meeting);
+        if (forwardDone < 0 || backwardDone < 0) return -1;
+    }
+    query->settled = forward->settled + backward->settled;
+    return best;
+}
+
+// Middle node of the arc between a and b, stored at the lower-ranked end
+static int arcMiddle(const ContractionHierarchy* ch, int a, int b) {
+    int low = (ch->rank[a] < ch->rank[b]) ? a : b;
+    int high = (low == a) ? b : a;
+    for (int i = ch->offsets[low]; i < ch->offsets[low + 1]; i++) {
+        if (ch->targets[i] == high) return ch->middle[i];
+    }
+    return -1;
+}
+
+typedef struct {
+    int* items;
+    int count;
+    int capacity;
+} IntStack;
+
+static int stackPush(IntStack* stack, int value) {
+    if (stack->count == stack->capacity) {
+        int capacity = stack->capacity ? stack->capacity * 2 : 64;
+        int* items = (int*)realloc(stack->items, capacity * sizeof(int));
+        if (items == NULL) return -1;
+        stack->items = items;
+        stack->capacity = capacity;
+    }
+    stack->items[stack->count++] = value;
+    return 0;
+}
+
+// Append the nodes after a on the road-level path a -> b, expanding shortcuts
+// depth-first with an explicit stack of pending (from, to) arcs
+static int unpackArc(const ContractionHierarchy* ch, IntStack* pending, int a, int b,
+                     int* path, int capacity, int* length) {
+    pending->count = 0;
+    if (stackPush(pending, a) != 0 || stackPush(pending, b) != 0) return -1;
+    while (pending->count > 0) {
+        int to = pending->items[--pending->count];
+        int from = pending->items[--pending->count];
+        int middle = arcMiddle(ch, from, to);
+        if (middle == -1) {
+            if (*length < capacity) path[*length] = to;
+            (*length)++;
+            continue;
+        }
+        // from -> middle is expanded first, so it goes on top
+        if (stackPush(pending, middle) != 0 || stackPush(pending, to) != 0 ||
+            stackPush(pending, from) != 0 || stackPush(pending, middle) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int chPath(const ContractionHierarchy* ch, const ChQuery* query, int* path, int capacity) {
+    if (query->meeting == -1) return 0;
+
+    // Hierarchy-level route: forward chain up to the meeting node, then the backward chain down
+    IntStack route = { NULL, 0, 0 };
+    IntStack pending = { NULL, 0, 0 };
+    int status = 0;
+    for (int at = query->meeting; at != -1 && status == 0; at = searchPrevious(&query->forward, at)) {
+        status = stackPush(&route, at);
+    }
+    for (int i = 0, j = route.count - 1; i < j; i++, j--) {
+        int swap = route.items[i];
+        route.items[i] = route.items[j];
+        route.items[j] = swap;
+    }
+    for (int at = searchPrevious(&query->backward, query->meeting); at != -1 && status == 0;
+         at = searchPrevious(&query->backward, at)) {
+        status = stackPush(&route, at);
+    }
+
+    int length = 0;
+    if (status == 0 && route.count > 0) {
+        if (capacity > 0) path[0] = route.items[0];
+        length = 1;
+        for (int i = 0; i + 1 < route.count && status == 0; i++) {
+            status = unpackArc(ch, &pending, route.items[i], route.items[i + 1], path, capacity, &length);
+        }
+    }
+    free(route.items);
+    free(pending.items);
+    return (status == 0) ? length : -1;
+}
+
+void chRoute(const Graph* graph, const ContractionHierarchy* ch, const char* startNode, const char* endNode) {
+    int startIndex = findNode(graph, startNode);
+    int endIndex = findNode(graph, endNode);
+    if (startIndex == -1 || endIndex == -1) {
+        printf("Invalid start or end node.\n");
+        return;
+    }
+
+    ChQuery query;
+    int* path = (int*)malloc((ch->nodeCount + 1) * sizeof(int));
+    if (path == NULL || chQueryInit(&query, ch->nodeCount) != 0) {
+        printf("Out of memory.\n");
+        free(path);
+        return;
+    }
+    int totalDistance = chQuery(ch, &query, startIndex, endIndex);
+    int length = (totalDistance >= 0 && totalDistance != UNREACHABLE) ? chPath(ch, &query, path, ch->nodeCount + 1) : 0;
+
+    if (totalDistance < 0 || length < 0) {
+        printf("Out of memory.\n");
+    } else if (totalDistance == UNREACHABLE) {
+        printf("No path found from %s to %s.\n", startNode, endNode);
+    } else {
+        // Same order as dijkstra: destination first
+        printf("Shortest path from %s to %s:\n", startNode, endNode);
+        for (int i = length - 1; i >= 0; i--) {
+            printf("%s ", graph->nodes[path[i]].name);
+        }
+        printf("\nTotal travel time: %d\n", totalDistance);
+    }
+    chQueryFree(&query);
+    free(path);
+}
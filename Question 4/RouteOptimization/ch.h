@@ -0,0 +1,70 @@
+#ifndef CH_H
+#define CH_H
+
+#include "graph.h"
+#include "search.h"
+
+#define CH_WITNESS_SETTLE_LIMIT 500  // Nodes a witness search may settle while contracting
+#define CH_PRIORITY_SETTLE_LIMIT 50  // Same, while only estimating a node's priority
+#define CH_FILE_MAGIC "ROUTECH2"
+#define CH_BYTE_ORDER 0x01020304u  // Written natively; reads back differently on the other byte order
+
+// Contraction hierarchy over a finalized, symmetric road graph. Every node has a
+// rank; each node stores its arcs to higher-ranked neighbors, which serve both the
+// forward and the backward search since roads run both ways.
+typedef struct {
+    int nodeCount;
+    int graphEdgeCount;  // Directed edges of the graph it was built from
+    unsigned int version; // Graph version it matches; any later change makes it stale
+    unsigned long long graphChecksum; // FNV-1a of the graph's offsets, targets and weights
+    int* rank;           // Contraction position per node (0 = contracted first)
+    int* offsets;        // Upward arcs of v: [offsets[v], offsets[v + 1])
+    int* targets;        // Higher-ranked endpoint
+    int* weights;        // Travel time
+    int* middle;         // Node a shortcut bypasses, -1 for an original road
+    int arcCount;
+    int shortcutCount;
+} ContractionHierarchy;
+
+// Reusable state for hierarchy queries: one search per direction
+typedef struct {
+    SearchState forward;
+    SearchState backward;
+    int meeting;         // Node where the best forward and backward paths meet, -1 if none
+    int settled;         // Nodes settled by the last query, both directions
+} ChQuery;
+
+int chBuild(ContractionHierarchy* ch, const Graph* graph);
+void chFree(ContractionHierarchy* ch);
+int chSave(const ContractionHierarchy* ch, const char* path);
+
+// Load a hierarchy saved for this graph. The file must come from a machine with the
+// same byte order and int width, match the graph's roads and travel times exactly, and
+// be a valid hierarchy (ranks a permutation, arcs upward, middles below both ends).
+// Returns 0, or -1 with a message on any mismatch.
+int chLoad(ContractionHierarchy* ch, const char* path, const Graph* graph);
+
+// Checksum of a finalized graph's roads and travel times, as stored in hierarchy files
+unsigned long long chGraphChecksum(const Graph* graph);
+
+int chQueryInit(ChQuery* query, int capacity);
+void chQueryFree(ChQuery* query);
+
+// Travel time from source to target (UNREACHABLE if none), -1 on error
+int chQuery(const ContractionHierarchy* ch, ChQuery* query, int source, int target);
+
+// Junction sequence of the last chQuery, source first, with every shortcut expanded.
+// Writes up to capacity nodes into path and returns the full length (0 if no path, -1 on error).
+int chPath(const ContractionHierarchy* ch, const ChQuery* query, int* path, int capacity);
+
+// Called for each node an upward search settles, with its travel time from the source
+typedef void (*ChVisit)(void* context, int node, int distance);
+
+// Run an upward search from source to exhaustion, calling visit for every settled node
+// that is not stalled. Building block for many-to-many queries. Returns 0, or -1 on error.
+int chUpwardSearch(const ContractionHierarchy* ch, SearchState* state, int source, ChVisit visit, void* context);
+
+// Print the route like dijkstra does
+void chRoute(const Graph* graph, const ContractionHierarchy* ch, const char* startNode, const char* endNode);
+
+#endif // CH_H
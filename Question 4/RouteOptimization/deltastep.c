@@ -0,0 +1,345 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "deltastep.h"
+
+static int listPush(IntList* list, int value) {
+    if (list->count == list->capacity) {
+        int capacity = list->capacity ? list->capacity * 2 : 64;
+        int* items = (int*)realloc(list->items, capacity * sizeof(int));
+        if (items == NULL) return -1;
+        list->items = items;
+        list->capacity = capacity;
+    }
+    list->items[list->count++] = value;
+    return 0;
+}
+
+int deltaStepperInit(DeltaStepper* stepper, int threadCount) {
+    memset(stepper, 0, sizeof(DeltaStepper));
+    if (threadPoolInit(&stepper->pool, threadCount) != 0) return -1;
+    stepper->workerCount = stepper->pool.threadCount;
+    stepper->workers = (StepperBins*)calloc(stepper->workerCount, sizeof(StepperBins));
+    if (stepper->workers == NULL) {
+        deltaStepperFree(stepper);
+        return -1;
+    }
+    return 0;
+}
+
+static void freeBins(DeltaStepper* stepper) {
+    for (int w = 0; w < stepper->workerCount; w++) {
+        for (int b = 0; b < stepper->binCount && stepper->workers[w].bins != NULL; b++) {
+            free(stepper->workers[w].bins[b].items);
+        }
+        free(stepper->workers[w].bins);
+        stepper->workers[w].bins = NULL;
+    }
+    stepper->binCount = 0;
+}
+
+void deltaStepperFree(DeltaStepper* stepper) {
+    if (stepper->workers != NULL) {
+        freeBins(stepper);
+        for (int w = 0; w < stepper->workerCount; w++) {
+            free(stepper->workers[w].processed.items);
+        }
+    }
+    free(stepper->workers);
+    free(stepper->distance);
+    free(stepper->previous);
+    free(stepper->round);
+    free(stepper->frontier);
+    threadPoolFree(&stepper->pool);
+    memset(stepper, 0, sizeof(DeltaStepper));
+}
+
+int deltaStepAutoDelta(const Graph* graph) {
+    int maxWeight = 0;
+    for (int e = 0; e < graph->edgeCount; e++) {
+        if (graph->weights[e] > maxWeight) maxWeight = graph->weights[e];
+    }
+    int averageDegree = graph->nodeCount ? (graph->edgeCount + graph->nodeCount - 1) / graph->nodeCount : 1;
+    if (averageDegree < 1) averageDegree = 1;
+    int delta = maxWeight / averageDegree;
+    return (delta > 0) ? delta : 1;
+}
+
+// Size the node arrays and the per-worker buckets for this graph and delta
+static int prepare(DeltaStepper* stepper, const Graph* graph, int delta) {
+    int n = graph->nodeCount;
+    if (n > stepper->capacity) {
+        int* distance = (int*)realloc(stepper->distance, n * sizeof(int));
+        if (distance == NULL) return -1;
+        stepper->distance = distance;
+        int* previous = (int*)realloc(stepper->previous, n * sizeof(int));
+        if (previous == NULL) return -1;
+        stepper->previous = previous;
+        int* round = (int*)realloc(stepper->round, n * sizeof(int));
+        if (round == NULL) return -1;
+        stepper->round = round;
+        stepper->capacity = n;
+    }
+
+    // A pushed distance is below the current bucket's end plus the largest weight, so
+    // live buckets never span more than maxWeight / delta + 2 indices
+    int maxWeight = 0;
+    for (int e = 0; e < graph->edgeCount; e++) {
+        if (graph->weights[e] > maxWeight) maxWeight = graph->weights[e];
+    }
+    int binCount = maxWeight / delta + 2;
+    if (binCount != stepper->binCount) {
+        freeBins(stepper);
+        for (int w = 0; w < stepper->workerCount; w++) {
+            stepper->workers[w].bins = (IntList*)calloc(binCount, sizeof(IntList));
+            if (stepper->workers[w].bins == NULL) {
+                stepper->binCount = binCount; // Let freeBins walk the lists allocated so far
+                freeBins(stepper);
+                return -1;
+            }
+        }
+        stepper->binCount = binCount;
+    }
+    for (int w = 0; w < stepper->workerCount; w++) {
+        for (int b = 0; b < binCount; b++) {
+            stepper->workers[w].bins[b].count = 0;
+        }
+        stepper->workers[w].processed.count = 0;
+    }
+    stepper->delta = delta;
+    return 0;
+}
+
+typedef enum { PHASE_LIGHT, PHASE_HEAVY } StepPhase;
+
+typedef struct {
+    DeltaStepper* stepper;
+    const Graph* graph;
+    StepPhase phase;
+    int frontierCount;
+    int roundNumber;     // Stamped on every node improved this round
+    int cursor;          // Next frontier index to claim
+    int processed;       // Frontier nodes that were still current
+    int failed;
+} StepRound;
+
+// Lower distance[node] to candidate if that improves it; 1 if this call did
+static int relaxAtomic(int* distance, int node, int candidate) {
+    int old = __atomic_load_n(&distance[node], __ATOMIC_RELAXED);
+    while (candidate < old) {
+        if (__atomic_compare_exchange_n(&distance[node], &old, candidate, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void roundWorker(void* context, int worker, int workers) {
+    StepRound* round = (StepRound*)context;
+    DeltaStepper* stepper = round->stepper;
+    const Graph* graph = round->graph;
+    StepperBins* bins = &stepper->workers[worker];
+    int delta = stepper->delta;
+    int processed = 0;
+    (void)workers;
+
+    for (;;) {
+        int start = __atomic_fetch_add(&round->cursor, DELTA_CHUNK, __ATOMIC_RELAXED);
+        if (start >= round->frontierCount) break;
+        int end = (start + DELTA_CHUNK < round->frontierCount) ? start + DELTA_CHUNK : round->frontierCount;
+        for (int i = start; i < end; i++) {
+            int node;
+            int distance;
+            if (round->phase == PHASE_LIGHT) {
+                // Relax with the distance the entry was pushed with, not one another
+                // worker may have lowered it to during this round: what a round sees
+                // then never depends on timing. An entry whose node has improved since
+                // is stale; a newer entry carries the better distance.
+                node = stepper->frontier[2 * i];
+                distance = stepper->frontier[2 * i + 1];
+                if (__atomic_load_n(&stepper->distance[node], __ATOMIC_RELAXED) < distance) continue;
+                if (listPush(&bins->processed, node) != 0) goto failed;
+            } else {
+                node = stepper->frontier[i];
+                distance = stepper->distance[node]; // Final once its bucket is done
+            }
+            processed++;
+            for (int e = graph->offsets[node]; e < graph->offsets[node + 1]; e++) {
+                int weight = graph->weights[e];
+                if ((weight <= delta) != (round->phase == PHASE_LIGHT)) continue;
+                int next = graph->targets[e];
+                int candidate = distance + weight;
+                if (relaxAtomic(stepper->distance, next, candidate)) {
+                    __atomic_store_n(&stepper->round[next], round->roundNumber, __ATOMIC_RELAXED);
+                    IntList* bin = &bins->bins[(candidate / delta) % stepper->binCount];
+                    if (listPush(bin, next) != 0 || listPush(bin, candidate) != 0) goto failed;
+                }
+            }
+        }
+    }
+    __atomic_fetch_add(&round->processed, processed, __ATOMIC_RELAXED);
+    return;
+
+failed:
+    __atomic_store_n(&round->failed, 1, __ATOMIC_RELAXED);
+}
+
+// Move every worker's list for a bucket (node, distance pairs) or their processed lists
+// (nodes) into the frontier; returns the number of entries
+static int gatherFrontier(DeltaStepper* stepper, int bucket, int processedLists) {
+    long total = 0;
+    for (int w = 0; w < stepper->workerCount; w++) {
+        StepperBins* bins = &stepper->workers[w];
+        total += processedLists ? bins->processed.count : bins->bins[bucket % stepper->binCount].count;
+    }
+    if (total > stepper->frontierCapacity) {
+        int* frontier = (int*)realloc(stepper->frontier, total * sizeof(int));
+        if (frontier == NULL) return -1;
+        stepper->frontier = frontier;
+        stepper->frontierCapacity = (int)total;
+    }
+    int at = 0;
+    for (int w = 0; w < stepper->workerCount; w++) {
+        IntList* list = processedLists ? &stepper->workers[w].processed
+                                       : &stepper->workers[w].bins[bucket % stepper->binCount];
+        if (list->count == 0) continue;
+        memcpy(stepper->frontier + at, list->items, list->count * sizeof(int));
+        at += list->count;
+        list->count = 0;
+    }
+    return processedLists ? at : at / 2;
+}
+
+typedef struct {
+    DeltaStepper* stepper;
+    const Graph* graph;
+    int source;
+} NodeTask;
+
+// Lowest-numbered neighbor on a shortest path whose distance was final in an earlier
+// round; the rounds rule out cycles through zero-weight roads
+static void predecessorWorker(void* context, int worker, int workers) {
+    NodeTask* task = (NodeTask*)context;
+    DeltaStepper* stepper = task->stepper;
+    const Graph* graph = task->graph;
+    int n = graph->nodeCount;
+    int begin = (int)((long)n * worker / workers);
+    int end = (int)((long)n * (worker + 1) / workers);
+    for (int v = begin; v < end; v++) {
+        int best = -1;
+        int distance = stepper->distance[v];
+        if (v != task->source && distance != UNREACHABLE) {
+            for (int e = graph->offsets[v]; e < graph->offsets[v + 1]; e++) {
+                int u = graph->targets[e];
+                if (stepper->distance[u] == UNREACHABLE || stepper->distance[u] + graph->weights[e] != distance) continue;
+                if (stepper->round[u] < stepper->round[v] && (best == -1 || u < best)) best = u;
+            }
+        }
+        stepper->previous[v] = best;
+    }
+}
+
+static void resetWorker(void* context, int worker, int workers) {
+    NodeTask* task = (NodeTask*)context;
+    int n = task->graph->nodeCount;
+    int begin = (int)((long)n * worker / workers);
+    int end = (int)((long)n * (worker + 1) / workers);
+    for (int v = begin; v < end; v++) {
+        task->stepper->distance[v] = UNREACHABLE;
+        task->stepper->round[v] = 0;
+    }
+}
+
+int deltaSteppingSearch(DeltaStepper* stepper, const Graph* graph, int source, int delta) {
+    if (!graph->finalized || source < 0 || source >= graph->nodeCount) return -1;
+    if (delta <= 0) delta = deltaStepAutoDelta(graph);
+    if (prepare(stepper, graph, delta) != 0) return -1;
+
+    NodeTask nodes = { stepper, graph, source };
+    threadPoolRun(&stepper->pool, resetWorker, &nodes);
+    stepper->distance[source] = 0;
+    if (listPush(&stepper->workers[0].bins[0], source) != 0 || listPush(&stepper->workers[0].bins[0], 0) != 0) {
+        return -1;
+    }
+
+    StepRound round;
+    memset(&round, 0, sizeof(round));
+    round.stepper = stepper;
+    round.graph = graph;
+    round.roundNumber = 1;
+    int bucket = 0;
+    int frontierCount = gatherFrontier(stepper, bucket, 0);
+
+    while (frontierCount >= 0) {
+        // Light edges of the bucket, round after round, until nothing lands in it again
+        round.phase = PHASE_LIGHT;
+        while (frontierCount > 0) {
+            round.frontierCount = frontierCount;
+            round.cursor = 0;
+            round.processed = 0;
+            threadPoolRun(&stepper->pool, roundWorker, &round);
+            if (round.failed) return -1;
+            if (round.processed > 0) round.roundNumber++;
+            frontierCount = gatherFrontier(stepper, bucket, 0);
+            if (frontierCount < 0) return -1;
+        }
+
+        // Heavy edges of every node the bucket settled, once, with final distances
+        frontierCount = gatherFrontier(stepper, bucket, 1);
+        if (frontierCount < 0) return -1;
+        if (frontierCount > 0) {
+            round.phase = PHASE_HEAVY;
+            round.frontierCount = frontierCount;
+            round.cursor = 0;
+            round.processed = 0;
+            threadPoolRun(&stepper->pool, roundWorker, &round);
+            if (round.failed) return -1;
+            round.roundNumber++;
+        }
+
+        // Next non-empty bucket
+        int next = -1;
+        for (int step = 1; step < stepper->binCount && next == -1; step++) {
+            for (int w = 0; w < stepper->workerCount; w++) {
+                if (stepper->workers[w].bins[(bucket + step) % stepper->binCount].count > 0) {
+                    next = bucket + step;
+                    break;
+                }
+            }
+        }
+        if (next == -1) break;
+        bucket = next;
+        frontierCount = gatherFrontier(stepper, bucket, 0);
+    }
+    if (frontierCount < 0) return -1;
+
+    threadPoolRun(&stepper->pool, predecessorWorker, &nodes);
+    stepper->rounds = round.roundNumber - 1;
+    return 0;
+}
+
+void printTravelTimes(Graph* graph, const char* startNode) {
+    int startIndex = findNode(graph, startNode);
+    if (startIndex == -1) {
+        printf("Invalid start node.\n");
+        return;
+    }
+    DeltaStepper stepper;
+    if (finalizeGraph(graph) != 0 || deltaStepperInit(&stepper, 0) != 0) {
+        printf("Out of memory.\n");
+        return;
+    }
+    if (deltaSteppingSearch(&stepper, graph, startIndex, 0) != 0) {
+        printf("Out of memory.\n");
+    } else {
+        printf("Travel times from %s:\n", startNode);
+        for (int v = 0; v < graph->nodeCount; v++) {
+            if (stepper.distance[v] == UNREACHABLE) {
+                printf("  %s: unreachable\n", graph->nodes[v].name);
+            } else {
+                printf("  %s: %d\n", graph->nodes[v].name, stepper.distance[v]);
+            }
+        }
+    }
+    deltaStepperFree(&stepper);
+}
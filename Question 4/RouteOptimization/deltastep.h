@@ -0,0 +1,57 @@
+#ifndef DELTASTEP_H
+#define DELTASTEP_H
+
+#include "graph.h"
+#include "search.h"
+#include "threadpool.h"
+
+#define DELTA_CHUNK 64 // Frontier nodes a worker claims at a time
+
+typedef struct {
+    int* items;
+    int count;
+    int capacity;
+} IntList;
+
+// Entries one worker pushed during a round: one list of (node, distance) pairs per live
+// bucket, used circularly, plus the nodes it processed in the current bucket (for the
+// heavy-edge pass)
+typedef struct {
+    IntList* bins;
+    IntList processed;
+} StepperBins;
+
+// Parallel single-source shortest paths by delta-stepping. Tentative distances are
+// grouped into buckets of width delta; a bucket's light edges (weight <= delta) are
+// relaxed in parallel rounds until it empties, then its heavy edges once.
+typedef struct {
+    ThreadPool pool;
+    int* distance;       // Result: travel time from the source, UNREACHABLE if none
+    int* previous;       // Result: predecessor, -1 at the source and unreachable nodes
+    int* round;          // Round in which each node's distance last improved
+    int capacity;        // Node slots allocated
+    StepperBins* workers;
+    int workerCount;
+    int binCount;        // Live buckets always span fewer than this many bucket indices
+    int* frontier;       // Entries of the round: (node, distance) pairs, or nodes for heavy edges
+    int frontierCapacity;
+    int delta;           // Bucket width used by the last run
+    int rounds;          // Relaxation rounds of the last run
+} DeltaStepper;
+
+int deltaStepperInit(DeltaStepper* stepper, int threadCount);
+void deltaStepperFree(DeltaStepper* stepper);
+
+// Bucket width suited to the graph: the largest travel time divided by the average degree
+int deltaStepAutoDelta(const Graph* graph);
+
+// Full single-source search from source with bucket width delta (<= 0: deltaStepAutoDelta).
+// Distances equal those of dijkstraSearch. Each predecessor is the lowest-numbered
+// neighbor on a shortest path that was final before the node itself, so ties break the
+// same way for any thread count. Returns 0, or -1 on error.
+int deltaSteppingSearch(DeltaStepper* stepper, const Graph* graph, int source, int delta);
+
+// Print the travel time from startNode to every junction (a coverage map)
+void printTravelTimes(Graph* graph, const char* startNode);
+
+#endif // DELTASTEP_H
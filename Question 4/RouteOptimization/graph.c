@@ -3,36 +3,62 @@
 #include <string.h>
 #include <limits.h>
 #include "graph.h"
+#include "search.h"
 
 // Initialize the graph
 void initializeGraph(Graph* graph) {
+    graph->nodes = (Node*)malloc(INITIAL_NODE_CAPACITY * sizeof(Node));
     graph->nodeCount = 0;
+    graph->nodeCapacity = (graph->nodes != NULL) ? INITIAL_NODE_CAPACITY : 0;
+    nameIndexInit(&graph->names);
+    graph->offsets = NULL;
+    graph->targets = NULL;
+    graph->weights = NULL;
+    graph->edgeCount = 0;
+    graph->frozenCount = 0;
+    graph->finalized = 0;
+    graph->version = 0;
+    graph->shortenedVersion = 0;
 }
 
-// Add a node to the graph
+// Add a node to the graph; names must be unique
 int addNode(Graph* graph, const char* name) {
-    if (graph->nodeCount >= MAX_NODES) {
-        return -1; // Maximum nodes reached
+    if (findNode(graph, name) != -1) {
+        return -1; // Duplicate name
+    }
+    if (graph->nodeCount == graph->nodeCapacity) {
+        int capacity = graph->nodeCapacity ? graph->nodeCapacity * 2 : INITIAL_NODE_CAPACITY;
+        Node* nodes = (Node*)realloc(graph->nodes, capacity * sizeof(Node));
+        if (nodes == NULL) {
+            return -1; // Out of memory
+        }
+        graph->nodes = nodes;
+        graph->nodeCapacity = capacity;
     }
     graph->nodes[graph->nodeCount].name = strdup(name);
+    if (graph->nodes[graph->nodeCount].name == NULL) {
+        return -1;
+    }
+    if (nameIndexAdd(&graph->names, graph->nodes[graph->nodeCount].name) == -1) {
+        free(graph->nodes[graph->nodeCount].name);
+        return -1;
+    }
     graph->nodes[graph->nodeCount].edges = NULL;
     graph->nodeCount++;
+    graph->finalized = 0;
+    graph->version++;
     return 0; // Success
 }
 
+// Index of the node with this name, or -1 (O(1) expected via the name index)
+int findNode(const Graph* graph, const char* name) {
+    return nameIndexFind(&graph->names, name);
+}
+
 // Add an edge to the graph
 void addEdge(Graph* graph, const char* from, const char* to, int weight) {
-    int fromIndex = -1, toIndex = -1;
-
-    // Find indices for from and to nodes
-    for (int i = 0; i < graph->nodeCount; i++) {
-        if (strcmp(graph->nodes[i].name, from) == 0) {
-            fromIndex = i;
-        }
-        if (strcmp(graph->nodes[i].name, to) == 0) {
-            toIndex = i;
-        }
-    }
+    int fromIndex = findNode(graph, from);
+    int toIndex = findNode(graph, to);
 
     if (fromIndex != -1 && toIndex != -1) {
         // Create a new edge for from
@@ -48,75 +74,211 @@ void addEdge(Graph* graph, const char* from, const char* to, int weight) {
         newEdge->weight = weight;
         newEdge->next = graph->nodes[toIndex].edges;
         graph->nodes[toIndex].edges = newEdge;
+        graph->finalized = 0;
+        graph->shortenedVersion = ++graph->version;
     } else {
         printf("Invalid node names.\n");
     }
 }
 
-// Dijkstra's algorithm to find the shortest path
-void dijkstra(Graph* graph, const char* startNode, const char* endNode) {
-    int distances[MAX_NODES];
-    int previous[MAX_NODES];
-    int visited[MAX_NODES] = {0};
-    int startIndex = -1, endIndex = -1;
+// Merge the pending edge lists into the CSR arrays. Each node's finalized edges
+// come first, then its pending ones in list order. Returns 0, or -1 if memory runs out.
+int finalizeGraph(Graph* graph) {
+    if (graph->finalized) return 0;
+    int n = graph->nodeCount;
+    int* offsets = (int*)malloc((n + 1) * sizeof(int));
+    if (offsets == NULL) return -1;
 
-    // Initialize distances and previous nodes
-    for (int i = 0; i < graph->nodeCount; i++) {
-        distances[i] = INT_MAX; // Set to infinity
-        previous[i] = -1;       // No previous node
-        if (strcmp(graph->nodes[i].name, startNode) == 0) {
-            startIndex = i;     // Start node index
+    offsets[0] = 0;
+    for (int v = 0; v < n; v++) {
+        int degree = (v < graph->frozenCount) ? graph->offsets[v + 1] - graph->offsets[v] : 0;
+        for (Edge* edge = graph->nodes[v].edges; edge != NULL; edge = edge->next) degree++;
+        offsets[v + 1] = offsets[v] + degree;
+    }
+    int* targets = (int*)malloc((offsets[n] + 1) * sizeof(int));
+    int* weights = (int*)malloc((offsets[n] + 1) * sizeof(int));
+    if (targets == NULL || weights == NULL) {
+        free(offsets);
+        free(targets);
+        free(weights);
+        return -1;
+    }
+
+    for (int v = 0; v < n; v++) {
+        int at = offsets[v];
+        if (v < graph->frozenCount) {
+            int begin = graph->offsets[v];
+            int degree = graph->offsets[v + 1] - begin;
+            memcpy(targets + at, graph->targets + begin, degree * sizeof(int));
+            memcpy(weights + at, graph->weights + begin, degree * sizeof(int));
+            at += degree;
         }
-        if (strcmp(graph->nodes[i].name, endNode) == 0) {
-            endIndex = i;       // End node index
+        Edge* edge = graph->nodes[v].edges;
+        while (edge != NULL) {
+            Edge* next = edge->next;
+            targets[at] = edge->target;
+            weights[at] = edge->weight;
+            at++;
+            free(edge);
+            edge = next;
         }
+        graph->nodes[v].edges = NULL;
     }
 
-    if (startIndex == -1 || endIndex == -1) {
-        printf("Invalid start or end node.\n");
-        return;
-    }
+    free(graph->offsets);
+    free(graph->targets);
+    free(graph->weights);
+    graph->offsets = offsets;
+    graph->targets = targets;
+    graph->weights = weights;
+    graph->edgeCount = offsets[n];
+    graph->frozenCount = n;
+    graph->finalized = 1;
+    return 0;
+}
 
-    distances[startIndex] = 0;
+// Replace every road with a ready CSR layout over all current nodes: offsets has
+// nodeCount + 1 entries and the graph takes ownership of all three arrays. Pending
+// edges are dropped. Used by bulk loaders that skip the per-road edge lists.
+void adoptRoads(Graph* graph, int* offsets, int* targets, int* weights) {
+    for (int v = 0; v < graph->nodeCount; v++) {
+        Edge* edge = graph->nodes[v].edges;
+        while (edge != NULL) {
+            Edge* next = edge->next;
+            free(edge);
+            edge = next;
+        }
+        graph->nodes[v].edges = NULL;
+    }
+    free(graph->offsets);
+    free(graph->targets);
+    free(graph->weights);
+    graph->offsets = offsets;
+    graph->targets = targets;
+    graph->weights = weights;
+    graph->edgeCount = offsets[graph->nodeCount];
+    graph->frozenCount = graph->nodeCount;
+    graph->finalized = 1;
+    graph->shortenedVersion = ++graph->version;
+}
 
-    for (int count = 0; count < graph->nodeCount - 1; count++) {
-        // Find the minimum distance node
-        int minDistance = INT_MAX;
-        int minIndex = -1;
+// Set the travel time of existing roads in a finalized graph, in both directions and
+// for every parallel road between the same pair. The batch is checked first and
+// applied only if every road exists and every weight is non-negative; returns 0 or -1.
+int updateRoadWeights(Graph* graph, const RoadUpdate* updates, int count) {
+    if (!graph->finalized) return -1;
+    for (int i = 0; i < count; i++) {
+        int from = updates[i].from;
+        int to = updates[i].to;
+        if (from < 0 || from >= graph->nodeCount || to < 0 || to >= graph->nodeCount || updates[i].weight < 0) {
+            return -1;
+        }
+        int found = 0;
+        for (int e = graph->offsets[from]; e < graph->offsets[from + 1] && !found; e++) {
+            found = graph->targets[e] == to;
+        }
+        if (!found) return -1;
+    }
 
-        for (int i = 0; i < graph->nodeCount; i++) {
-            if (!visited[i] && distances[i] < minDistance) {
-                minDistance = distances[i];
-                minIndex = i;
+    int shortened = 0;
+    for (int i = 0; i < count; i++) {
+        const RoadUpdate* update = &updates[i];
+        for (int side = 0; side < 2; side++) {
+            int from = side ? update->to : update->from;
+            int to = side ? update->from : update->to;
+            for (int e = graph->offsets[from]; e < graph->offsets[from + 1]; e++) {
+                if (graph->targets[e] != to) continue;
+                if (update->weight < graph->weights[e]) shortened = 1;
+                graph->weights[e] = update->weight;
             }
         }
+    }
+    graph->version++;
+    if (shortened) graph->shortenedVersion = graph->version;
+    return 0;
+}
 
-        if (minIndex == -1) break; // All reachable nodes visited
-
-        visited[minIndex] = 1;
+// Dijkstra's algorithm to find the shortest path
+void dijkstra(Graph* graph, const char* startNode, const char* endNode) {
+    int startIndex = findNode(graph, startNode);
+    int endIndex = findNode(graph, endNode);
+    if (startIndex == -1 || endIndex == -1) {
+        printf("Invalid start or end node.\n");
+        return;
+    }
+    if (finalizeGraph(graph) != 0) {
+        printf("Out of memory.\n");
+        return;
+    }
 
-        // Update distances for adjacent nodes
-        for (Edge* edge = graph->nodes[minIndex].edges; edge != NULL; edge = edge->next) {
-            int target = edge->target;
-            if (!visited[target] && distances[minIndex] + edge->weight < distances[target]) {
-                distances[target] = distances[minIndex] + edge->weight;
-                previous[target] = minIndex;
-            }
-        }
+    SearchState state;
+    if (searchStateInit(&state, graph->nodeCount, QUEUE_FOUR_ARY) != 0) {
+        printf("Out of memory.\n");
+        return;
     }
+    int totalDistance = dijkstraSearch(graph, &state, startIndex, endIndex);
 
     // Output the shortest path
-    int totalDistance = distances[endIndex];
-    if (totalDistance == INT_MAX) {
+    if (totalDistance < 0) {
+        printf("Out of memory.\n");
+    } else if (totalDistance == UNREACHABLE) {
         printf("No path found from %s to %s.\n", startNode, endNode);
+    } else {
+        printf("Shortest path from %s to %s:\n", startNode, endNode);
+        for (int at = endIndex; at != -1; at = searchPrevious(&state, at)) {
+            printf("%s ", graph->nodes[at].name);
+        }
+        printf("\nTotal travel time: %d\n", totalDistance);
+    }
+    searchStateFree(&state);
+}
+
+// Same route as dijkstra, found by searching from both ends at once
+void bidirectionalDijkstra(Graph* graph, const char* startNode, const char* endNode) {
+    int startIndex = findNode(graph, startNode);
+    int endIndex = findNode(graph, endNode);
+    if (startIndex == -1 || endIndex == -1) {
+        printf("Invalid start or end node.\n");
+        return;
+    }
+    if (finalizeGraph(graph) != 0) {
+        printf("Out of memory.\n");
         return;
     }
 
-    printf("Shortest path from %s to %s:\n", startNode, endNode);
-    for (int at = endIndex; at != -1; at = previous[at]) {
-        printf("%s ", graph->nodes[at].name);
+    SearchState forward;
+    SearchState backward;
+    int* path = (int*)malloc(graph->nodeCount * sizeof(int));
+    if (path == NULL || searchStateInit(&forward, graph->nodeCount, QUEUE_FOUR_ARY) != 0) {
+        printf("Out of memory.\n");
+        free(path);
+        return;
     }
-    printf("\nTotal travel time: %d\n", totalDistance);
+    if (searchStateInit(&backward, graph->nodeCount, QUEUE_FOUR_ARY) != 0) {
+        printf("Out of memory.\n");
+        searchStateFree(&forward);
+        free(path);
+        return;
+    }
+    int meeting;
+    int totalDistance = bidirectionalSearch(graph, &forward, &backward, startIndex, endIndex, &meeting);
+
+    if (totalDistance < 0) {
+        printf("Out of memory.\n");
+    } else if (totalDistance == UNREACHABLE) {
+        printf("No path found from %s to %s.\n", startNode, endNode);
+    } else {
+        // Same order as dijkstra: destination first
+        int length = bidirectionalPath(&forward, &backward, meeting, path, graph->nodeCount);
+        printf("Shortest path from %s to %s:\n", startNode, endNode);
+        for (int i = length - 1; i >= 0; i--) {
+            printf("%s ", graph->nodes[path[i]].name);
+        }
+        printf("\nTotal travel time: %d\n", totalDistance);
+    }
+    searchStateFree(&forward);
+    searchStateFree(&backward);
+    free(path);
 }
 
 // Free the graph's allocated memory
@@ -130,4 +292,20 @@ void freeGraph(Graph* graph) {
             free(temp);
         }
     }
+    free(graph->nodes);
+    nameIndexFree(&graph->names);
+    free(graph->offsets);
+    free(graph->targets);
+    free(graph->weights);
+    graph->nodes = NULL;
+    graph->offsets = NULL;
+    graph->targets = NULL;
+    graph->weights = NULL;
+    graph->nodeCount = 0;
+    graph->nodeCapacity = 0;
+    graph->edgeCount = 0;
+    graph->frozenCount = 0;
+    graph->finalized = 0;
+    graph->version = 0;
+    graph->shortenedVersion = 0;
 }
@@ -2,9 +2,11 @@
 #define GRAPH_H
 
 #include <limits.h>
+#include "names.h"
 
-#define MAX_NODES 10  // Maximum number of nodes in the graph
+#define INITIAL_NODE_CAPACITY 16 // Node slots reserved by initializeGraph
 
+// Road added since the last finalizeGraph, waiting to be merged into the CSR arrays
 typedef struct Edge {
     int target;          // Target node index
     int weight;         // Weight (travel time)
@@ -13,19 +15,43 @@ typedef struct Edge {
 
 typedef struct Node {
     char* name;         // Name of the node (junction/sector)
-    Edge* edges;        // List of edges
+    Edge* edges;        // Edges not yet finalized
 } Node;
 
 typedef struct Graph {
-    Node nodes[MAX_NODES]; // Array of nodes
+    Node* nodes;           // Growable array of nodes
     int nodeCount;         // Current number of nodes
+    int nodeCapacity;      // Allocated node slots
+    NameIndex names;       // Name -> node index
+    // Compressed sparse row layout built by finalizeGraph: the edges of node v are
+    // targets[offsets[v]] .. targets[offsets[v + 1] - 1], with matching weights
+    int* offsets;          // frozenCount + 1 entries
+    int* targets;
+    int* weights;
+    int edgeCount;         // Directed edges in the CSR arrays (two per road)
+    int frozenCount;       // Nodes covered by offsets
+    int finalized;         // 1 when the CSR arrays hold every node and edge
+    unsigned int version;  // Bumped by every change to nodes, roads or travel times
+    unsigned int shortenedVersion; // Version of the last change that may have shortened a route
 } Graph;
 
+// New travel time for the road between two nodes (both directions)
+typedef struct {
+    int from;
+    int to;
+    int weight;
+} RoadUpdate;
+
 // Function prototypes
 void initializeGraph(Graph* graph);
 int addNode(Graph* graph, const char* name);
 void addEdge(Graph* graph, const char* from, const char* to, int weight);
+int findNode(const Graph* graph, const char* name);
+int finalizeGraph(Graph* graph);
+void adoptRoads(Graph* graph, int* offsets, int* targets, int* weights);
+int updateRoadWeights(Graph* graph, const RoadUpdate* updates, int count);
 void dijkstra(Graph* graph, const char* startNode, const char* endNode);
+void bidirectionalDijkstra(Graph* graph, const char* startNode, const char* endNode);
 void freeGraph(Graph* graph);
 
 #endif // GRAPH_H
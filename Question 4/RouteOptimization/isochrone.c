@@ -0,0 +1,133 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "isochrone.h"
+
+#define ISOCHRONE_INITIAL_CAPACITY 64
+
+void isochroneInit(Isochrone* isochrone) {
+    isochrone->source = -1;
+    isochrone->budget = 0;
+    isochrone->nodes = NULL;
+    isochrone->times = NULL;
+    isochrone->count = 0;
+    isochrone->capacity = 0;
+}
+
+void isochroneFree(Isochrone* isochrone) {
+    free(isochrone->nodes);
+    free(isochrone->times);
+    isochroneInit(isochrone);
+}
+
+static int isochroneAppend(Isochrone* isochrone, int node, int time) {
+    if (isochrone->count == isochrone->capacity) {
+        int capacity = isochrone->capacity ? isochrone->capacity * 2 : ISOCHRONE_INITIAL_CAPACITY;
+        int* nodes = (int*)realloc(isochrone->nodes, capacity * sizeof(int));
+        if (nodes == NULL) return -1;
+        isochrone->nodes = nodes;
+        int* times = (int*)realloc(isochrone->times, capacity * sizeof(int));
+        if (times == NULL) return -1;
+        isochrone->times = times;
+        isochrone->capacity = capacity;
+    }
+    isochrone->nodes[isochrone->count] = node;
+    isochrone->times[isochrone->count] = time;
+    isochrone->count++;
+    return 0;
+}
+
+int isochroneSearch(const Graph* graph, SearchState* state, int source, int budget, Isochrone* result) {
+    result->source = source;
+    result->budget = budget;
+    result->count = 0;
+    if (!graph->finalized || source < 0 || source >= graph->nodeCount) return -1;
+    if (searchStateReserve(state, graph->nodeCount) != 0) return -1;
+    searchReset(state);
+    if (budget < 0) return 0;
+    searchRecord(state, source, 0, -1);
+    if (pqPush(&state->queue, source, 0) != 0) return -1;
+
+    int distance;
+    int node;
+    while ((node = pqPop(&state->queue, &distance)) != -1) {
+        state->settled++;
+        if (isochroneAppend(result, node, distance) != 0) return -1;
+
+        for (int e = graph->offsets[node]; e < graph->offsets[node + 1]; e++) {
+            int next = graph->targets[e];
+            int candidate = distance + graph->weights[e];
+            // Nodes past the budget are never queued, so the queue and the stamps
+            // written stay within the reachable region and its border
+            if (candidate <= budget && candidate < searchDistance(state, next)) {
+                searchRecord(state, next, candidate, node);
+                if (pqPush(&state->queue, next, candidate) != 0) return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+// ---- Batches ----
+
+typedef struct {
+    Dispatcher* dispatcher;
+    const Graph* graph;
+    const int* sources;
+    int sourceCount;
+    int budget;
+    Isochrone* results;
+    int cursor;              // Next source to claim
+    int failed;
+} IsochroneTask;
+
+static void isochroneWorker(void* context, int worker, int workers) {
+    IsochroneTask* task = (IsochroneTask*)context;
+    SearchState* state = &task->dispatcher->states[worker];
+    (void)workers;
+
+    for (;;) {
+        int i = __atomic_fetch_add(&task->cursor, 1, __ATOMIC_RELAXED);
+        if (i >= task->sourceCount) break;
+        if (isochroneSearch(task->graph, state, task->sources[i], task->budget, &task->results[i]) != 0) {
+            __atomic_store_n(&task->failed, 1, __ATOMIC_RELAXED);
+            return;
+        }
+    }
+}
+
+int isochroneBatch(Dispatcher* dispatcher, const Graph* graph, const int* sources, int sourceCount, int budget,
+                   Isochrone* results) {
+    if (!graph->finalized) return -1;
+    for (int i = 0; i < sourceCount; i++) {
+        if (sources[i] < 0 || sources[i] >= graph->nodeCount) return -1;
+    }
+    IsochroneTask task = { dispatcher, graph, sources, sourceCount, budget, results, 0, 0 };
+    threadPoolRun(&dispatcher->pool, isochroneWorker, &task);
+    return task.failed ? -1 : 0;
+}
+
+void printIsochrone(Graph* graph, const char* startNode, int budget) {
+    int startIndex = findNode(graph, startNode);
+    if (startIndex == -1) {
+        printf("Invalid start node.\n");
+        return;
+    }
+    SearchState state;
+    Isochrone isochrone;
+    isochroneInit(&isochrone);
+    if (finalizeGraph(graph) != 0 || searchStateInit(&state, graph->nodeCount, QUEUE_FOUR_ARY) != 0) {
+        printf("Out of memory.\n");
+        return;
+    }
+    if (isochroneSearch(graph, &state, startIndex, budget, &isochrone) != 0) {
+        printf("Out of memory.\n");
+    } else {
+        printf("Reachable from %s within %d:", startNode, budget);
+        for (int i = 0; i < isochrone.count; i++) {
+            printf(" %s (%d)", graph->nodes[isochrone.nodes[i]].name, isochrone.times[i]);
+        }
+        printf("\n");
+    }
+    isochroneFree(&isochrone);
+    searchStateFree(&state);
+}
@@ -0,0 +1,34 @@
+#ifndef ISOCHRONE_H
+#define ISOCHRONE_H
+
+#include "graph.h"
+#include "search.h"
+#include "matrix.h"
+
+// Junctions reachable from one source within a travel-time budget, in order of arrival.
+// The arrays keep their capacity across searches, so reusing an isochrone allocates nothing.
+typedef struct {
+    int source;
+    int budget;
+    int* nodes;          // Reachable junctions, closest first (the source first)
+    int* times;          // Travel time to nodes[i]
+    int count;
+    int capacity;
+} Isochrone;
+
+void isochroneInit(Isochrone* isochrone);
+void isochroneFree(Isochrone* isochrone);
+
+// Dijkstra from source that never queues a node beyond budget, so the work and the
+// state it touches are proportional to the reachable region. Returns 0, or -1 on error.
+int isochroneSearch(const Graph* graph, SearchState* state, int source, int budget, Isochrone* result);
+
+// One isochrone per source into results[i], spread across the dispatcher's workers and
+// their reusable search states. Returns 0, or -1 on error.
+int isochroneBatch(Dispatcher* dispatcher, const Graph* graph, const int* sources, int sourceCount, int budget,
+                   Isochrone* results);
+
+// Print the junctions reachable from startNode within budget, with their travel times
+void printIsochrone(Graph* graph, const char* startNode, int budget);
+
+#endif // ISOCHRONE_H
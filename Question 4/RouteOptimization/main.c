@@ -1,6 +1,13 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "graph.h"
+#include "ch.h"
+#include "alt.h"
+#include "matrix.h"
+#include "trees.h"
+#include "route.h"
+#include "deltastep.h"
+#include "isochrone.h"
 
 int main() {
     Graph graph;
@@ -25,9 +32,71 @@ int main() {
     addEdge(&graph, "Junction C", "Sector E", 6);
     addEdge(&graph, "Sector E", "Emergency Site", 4);
 
+    // Freeze the network into its compact routing layout
+    finalizeGraph(&graph);
+
     // Perform Dijkstra's algorithm
     dijkstra(&graph, "Dispatch Center", "Emergency Site");
 
+    // Same route, searched from both ends at once
+    bidirectionalDijkstra(&graph, "Dispatch Center", "Emergency Site");
+
+    // Same route through a contraction hierarchy, built once and reused for every query
+    ContractionHierarchy ch;
+    if (chBuild(&ch, &graph) == 0) {
+        chRoute(&graph, &ch, "Dispatch Center", "Emergency Site");
+        chFree(&ch);
+    }
+
+    // Goal-directed A* with landmark lower bounds
+    LandmarkSet landmarks;
+    landmarksInit(&landmarks);
+    if (landmarksBuild(&landmarks, &graph, ALT_DEFAULT_LANDMARKS) == 0) {
+        altRoute(&graph, &landmarks, "Dispatch Center", "Emergency Site");
+    }
+    landmarksFree(&landmarks);
+
+    // Travel times from every unit to every incident, computed in parallel
+    const char* units[] = { "Dispatch Center", "Sector D" };
+    const char* incidents[] = { "Emergency Site", "Sector E", "Junction C" };
+    dispatchMatrix(&graph, units, 2, incidents, 3);
+
+    // Keep the dispatch center's shortest-path tree current under live traffic:
+    // congestion between Sector E and the site is repaired into the cached tree
+    TreeCache trees;
+    if (treeCacheInit(&trees) == 0) {
+        if (treeCacheRegister(&trees, &graph, findNode(&graph, "Dispatch Center")) == 0) {
+            RoadUpdate congestion = { findNode(&graph, "Sector E"), findNode(&graph, "Emergency Site"), 20 };
+            if (treeCacheApply(&trees, &graph, &congestion, 1) == 0) {
+                treeRoute(&trees, &graph, "Dispatch Center", "Emergency Site");
+            }
+        }
+        treeCacheFree(&trees);
+    }
+
+    // Structured routes through the LRU cache: the repeated query is a cache hit
+    RouteCache routes;
+    if (routeCacheInit(&routes, DEFAULT_ROUTE_CACHE_SIZE) == 0) {
+        int nodes[16];
+        int legTimes[16];
+        Route route;
+        routeInit(&route, nodes, legTimes, 16);
+        for (int i = 0; i < 2; i++) {
+            if (routeCacheQuery(&routes, &graph, findNode(&graph, "Dispatch Center"),
+                                findNode(&graph, "Emergency Site"), &route) == 0) {
+                printRoute(&graph, &route);
+            }
+        }
+        printf("Route cache: %ld hits, %ld misses\n", routes.hits, routes.misses);
+        routeCacheFree(&routes);
+    }
+
+    // Coverage map: travel time from the dispatch center to every junction
+    printTravelTimes(&graph, "Dispatch Center");
+
+    // Coverage planning: junctions the dispatch center reaches within 25 minutes
+    printIsochrone(&graph, "Dispatch Center", 25);
+
     // Free allocated memory
     freeGraph(&graph);
     return 0;
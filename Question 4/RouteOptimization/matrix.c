@@ -0,0 +1,362 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "matrix.h"
+
+// Start the pool (0 = one worker per online CPU) and an empty search state per worker
+int dispatcherInit(Dispatcher* dispatcher, int threadCount) {
+    memset(dispatcher, 0, sizeof(Dispatcher));
+    if (threadPoolInit(&dispatcher->pool, threadCount) != 0) return -1;
+
+    int workers = dispatcher->pool.threadCount;
+    dispatcher->states = (SearchState*)malloc(workers * sizeof(SearchState));
+    if (dispatcher->states == NULL) {
+        dispatcherFree(dispatcher);
+        return -1;
+    }
+    for (int i = 0; i < workers; i++) {
+        if (searchStateInit(&dispatcher->states[i], 0, QUEUE_FOUR_ARY) != 0) {
+            dispatcherFree(dispatcher);
+            return -1;
+        }
+        dispatcher->stateCount++;
+    }
+    return 0;
+}
+
+void dispatcherFree(Dispatcher* dispatcher) {
+    for (int i = 0; i < dispatcher->stateCount; i++) {
+        searchStateFree(&dispatcher->states[i]);
+    }
+    free(dispatcher->states);
+    free(dispatcher->marks);
+    free(dispatcher->bucketOffsets);
+    free(dispatcher->bucketTarget);
+    free(dispatcher->bucketDistance);
+    free(dispatcher->entryNode);
+    free(dispatcher->entryTarget);
+    free(dispatcher->entryDistance);
+    threadPoolFree(&dispatcher->pool);
+    memset(dispatcher, 0, sizeof(Dispatcher));
+}
+
+void dispatcherUseHierarchy(Dispatcher* dispatcher, const ContractionHierarchy* ch) {
+    dispatcher->ch = ch;
+}
+
+// Flag the given nodes and return how many distinct ones there are, -1 on error
+static int markNodes(Dispatcher* dispatcher, const Graph* graph, const int* nodes, int count) {
+    if (dispatcher->markCapacity < graph->nodeCount) {
+        unsigned char* marks = (unsigned char*)realloc(dispatcher->marks, graph->nodeCount);
+        if (marks == NULL) return -1;
+        memset(marks + dispatcher->markCapacity, 0, graph->nodeCount - dispatcher->markCapacity);
+        dispatcher->marks = marks;
+        dispatcher->markCapacity = graph->nodeCount;
+    }
+    int distinct = 0;
+    for (int i = 0; i < count; i++) {
+        if (!dispatcher->marks[nodes[i]]) {
+            dispatcher->marks[nodes[i]] = 1;
+            distinct++;
+        }
+    }
+    return distinct;
+}
+
+// Clear only the flags markNodes set, so the array stays all zero between calls
+static void unmarkNodes(Dispatcher* dispatcher, const int* nodes, int count) {
+    for (int i = 0; i < count; i++) {
+        dispatcher->marks[nodes[i]] = 0;
+    }
+}
+
+// ---- Buckets ----
+
+typedef struct {
+    Dispatcher* dispatcher;
+    int target;        // Destination position being added
+    int failed;
+} BucketFill;
+
+static void addBucketEntry(void* context, int node, int distance) {
+    BucketFill* fill = (BucketFill*)context;
+    Dispatcher* dispatcher = fill->dispatcher;
+    if (dispatcher->entryCount == dispatcher->entryCapacity) {
+        int capacity = dispatcher->entryCapacity ? dispatcher->entryCapacity * 2 : 1024;
+        int* nodes = (int*)realloc(dispatcher->entryNode, capacity * sizeof(int));
+        if (nodes == NULL) {
+            fill->failed = 1;
+            return;
+        }
+        dispatcher->entryNode = nodes;
+        int* targets = (int*)realloc(dispatcher->entryTarget, capacity * sizeof(int));
+        if (targets == NULL) {
+            fill->failed = 1;
+            return;
+        }
+        dispatcher->entryTarget = targets;
+        int* distances = (int*)realloc(dispatcher->entryDistance, capacity * sizeof(int));
+        if (distances == NULL) {
+            fill->failed = 1;
+            return;
+        }
+        dispatcher->entryDistance = distances;
+        dispatcher->entryCapacity = capacity;
+    }
+    int at = dispatcher->entryCount++;
+    dispatcher->entryNode[at] = node;
+    dispatcher->entryTarget[at] = fill->target;
+    dispatcher->entryDistance[at] = distance;
+}
+
+// Run an upward search from every destination and group the nodes they settle by
+// node (counting sort), so an origin's search can look up all destinations it meets
+static int fillBuckets(Dispatcher* dispatcher, const int* targets, int targetCount) {
+    const ContractionHierarchy* ch = dispatcher->ch;
+    BucketFill fill = { dispatcher, 0, 0 };
+    dispatcher->entryCount = 0;
+    for (fill.target = 0; fill.target < targetCount; fill.target++) {
+        if (chUpwardSearch(ch, &dispatcher->states[0], targets[fill.target], addBucketEntry, &fill) != 0 ||
+            fill.failed) {
+            return -1;
+        }
+    }
+
+    if (dispatcher->offsetCapacity < ch->nodeCount + 1) {
+        int* offsets = (int*)realloc(dispatcher->bucketOffsets, (ch->nodeCount + 1) * sizeof(int));
+        if (offsets == NULL) return -1;
+        dispatcher->bucketOffsets = offsets;
+        dispatcher->offsetCapacity = ch->nodeCount + 1;
+    }
+    int* bucketTarget = (int*)realloc(dispatcher->bucketTarget, (dispatcher->entryCapacity + 1) * sizeof(int));
+    if (bucketTarget == NULL) return -1;
+    dispatcher->bucketTarget = bucketTarget;
+    int* bucketDistance = (int*)realloc(dispatcher->bucketDistance, (dispatcher->entryCapacity + 1) * sizeof(int));
+    if (bucketDistance == NULL) return -1;
+    dispatcher->bucketDistance = bucketDistance;
+
+    // Count per node, turn the counts into bucket ends, then place entries back to
+    // front so each offsets[v] steps down to the start of v's bucket
+    int* offsets = dispatcher->bucketOffsets;
+    memset(offsets, 0, (ch->nodeCount + 1) * sizeof(int));
+    for (int i = 0; i < dispatcher->entryCount; i++) {
+        offsets[dispatcher->entryNode[i]]++;
+    }
+    for (int v = 1; v < ch->nodeCount; v++) {
+        offsets[v] += offsets[v - 1];
+    }
+    offsets[ch->nodeCount] = dispatcher->entryCount;
+    for (int i = dispatcher->entryCount - 1; i >= 0; i--) {
+        int at = --offsets[dispatcher->entryNode[i]];
+        bucketTarget[at] = dispatcher->entryTarget[i];
+        bucketDistance[at] = dispatcher->entryDistance[i];
+    }
+    return 0;
+}
+
+// ---- Batches ----
+
+typedef struct {
+    Dispatcher* dispatcher;
+    const Graph* graph;
+    const int* sources;      // One search per source
+    int sourceCount;
+    const int* targets;      // Nodes each search reports
+    int targetCount;
+    int stopAfter;           // Flagged nodes to settle before a search stops
+    int k;                   // Row width for nearestUnits, 0 for the matrix
+    int* matrix;
+    int* nearest;
+    int* times;
+    int* rows;               // Scratch row per worker for nearestUnits
+    int useBuckets;
+    int cursor;              // Next source row to claim
+    int failed;
+} BatchTask;
+
+typedef struct {
+    const Dispatcher* dispatcher;
+    int* row;
+} BucketScan;
+
+// A node settled by an origin's upward search: every destination whose upward search
+// also reached it gets a route through it
+static void scanBucket(void* context, int node, int distance) {
+    BucketScan* scan = (BucketScan*)context;
+    const Dispatcher* dispatcher = scan->dispatcher;
+    for (int i = dispatcher->bucketOffsets[node]; i < dispatcher->bucketOffsets[node + 1]; i++) {
+        int candidate = distance + dispatcher->bucketDistance[i];
+        int* slot = &scan->row[dispatcher->bucketTarget[i]];
+        if (candidate < *slot) *slot = candidate;
+    }
+}
+
+// Keep the k smallest (time, unit) pairs of a row in ascending order
+static void insertNearest(int* nearest, int* times, int k, int unit, int time) {
+    if (time == UNREACHABLE || time >= times[k - 1]) return;
+    int i = k - 1;
+    while (i > 0 && times[i - 1] > time) {
+        nearest[i] = nearest[i - 1];
+        times[i] = times[i - 1];
+        i--;
+    }
+    nearest[i] = unit;
+    times[i] = time;
+}
+
+// Travel times from one source to every target
+static int computeRow(BatchTask* task, SearchState* state, int source, int* row) {
+    if (task->useBuckets) {
+        for (int j = 0; j < task->targetCount; j++) {
+            row[j] = UNREACHABLE;
+        }
+        BucketScan scan = { task->dispatcher, row };
+        return chUpwardSearch(task->dispatcher->ch, state, source, scanBucket, &scan);
+    }
+    if (dijkstraSearchSet(task->graph, state, source, task->dispatcher->marks, task->stopAfter) != 0) return -1;
+    for (int j = 0; j < task->targetCount; j++) {
+        row[j] = searchDistance(state, task->targets[j]);
+    }
+    return 0;
+}
+
+static void batchWorker(void* context, int worker, int workers) {
+    BatchTask* task = (BatchTask*)context;
+    SearchState* state = &task->dispatcher->states[worker];
+    (void)workers;
+
+    for (;;) {
+        int row = __atomic_fetch_add(&task->cursor, MATRIX_ROW_CHUNK, __ATOMIC_RELAXED);
+        if (row >= task->sourceCount) break;
+        int end = (row + MATRIX_ROW_CHUNK < task->sourceCount) ? row + MATRIX_ROW_CHUNK : task->sourceCount;
+        for (; row < end; row++) {
+            int* out = (task->k == 0) ? task->matrix + (size_t)row * task->targetCount
+                                      : task->rows + (size_t)worker * task->targetCount;
+            if (computeRow(task, state, task->sources[row], out) != 0) {
+                __atomic_store_n(&task->failed, 1, __ATOMIC_RELAXED);
+                return;
+            }
+            if (task->k > 0) {
+                // Without buckets, units not settled may hold a tentative time, but never
+                // one below the k-th settled unit, so they cannot displace a true nearest unit
+                int* nearest = task->nearest + (size_t)row * task->k;
+                int* times = task->times + (size_t)row * task->k;
+                for (int j = 0; j < task->k; j++) {
+                    nearest[j] = -1;
+                    times[j] = UNREACHABLE;
+                }
+                for (int j = 0; j < task->targetCount; j++) {
+                    insertNearest(nearest, times, task->k, j, out[j]);
+                }
+            }
+        }
+    }
+}
+
+static int runBatch(BatchTask* task) {
+    Dispatcher* dispatcher = task->dispatcher;
+    const Graph* graph = task->graph;
+    if (!graph->finalized) return -1;
+    for (int i = 0; i < task->sourceCount; i++) {
+        if (task->sources[i] < 0 || task->sources[i] >= graph->nodeCount) return -1;
+    }
+    for (int j = 0; j < task->targetCount; j++) {
+        if (task->targets[j] < 0 || task->targets[j] >= graph->nodeCount) return -1;
+    }
+    task->useBuckets = dispatcher->ch != NULL && dispatcher->ch->nodeCount == graph->nodeCount &&
+                       dispatcher->ch->version == graph->version;
+    if (task->k > 0 && task->targetCount > 0) {
+        task->rows = (int*)malloc((size_t)dispatcher->stateCount * task->targetCount * sizeof(int));
+        if (task->rows == NULL) return -1;
+    }
+
+    int status;
+    if (task->useBuckets) {
+        status = fillBuckets(dispatcher, task->targets, task->targetCount);
+    } else {
+        // A search may stop once it has settled every destination, or the k closest units
+        int distinct = markNodes(dispatcher, graph, task->targets, task->targetCount);
+        status = (distinct < 0) ? -1 : 0;
+        if (task->k == 0 || task->stopAfter > distinct) task->stopAfter = distinct;
+    }
+    if (status == 0) {
+        task->cursor = 0;
+        task->failed = 0;
+        threadPoolRun(&dispatcher->pool, batchWorker, task);
+        if (task->failed) status = -1;
+        if (!task->useBuckets) unmarkNodes(dispatcher, task->targets, task->targetCount);
+    }
+    free(task->rows);
+    return status;
+}
+
+int travelTimeMatrix(Dispatcher* dispatcher, const Graph* graph, const int* origins, int originCount,
+                     const int* destinations, int destinationCount, int* matrix) {
+    BatchTask task = { dispatcher, graph, origins, originCount, destinations, destinationCount, 0, 0,
+                       matrix, NULL, NULL, NULL, 0, 0, 0 };
+    return runBatch(&task);
+}
+
+// Roads are symmetric, so each incident searches outward until its k closest units
+// are settled instead of every unit searching toward every incident
+int nearestUnits(Dispatcher* dispatcher, const Graph* graph, const int* units, int unitCount,
+                 const int* incidents, int incidentCount, int k, int* nearest, int* times) {
+    if (k <= 0) return -1;
+    BatchTask task = { dispatcher, graph, incidents, incidentCount, units, unitCount, k, k,
+                       NULL, nearest, times, NULL, 0, 0, 0 };
+    return runBatch(&task);
+}
+
+void dispatchMatrix(Graph* graph, const char** units, int unitCount, const char** incidents, int incidentCount) {
+    if (unitCount <= 0 || incidentCount <= 0) return;
+    if (finalizeGraph(graph) != 0) {
+        printf("Out of memory.\n");
+        return;
+    }
+    int* origins = (int*)malloc((unitCount + incidentCount) * sizeof(int));
+    int* matrix = (int*)malloc((size_t)unitCount * incidentCount * sizeof(int));
+    if (origins == NULL || matrix == NULL) {
+        printf("Out of memory.\n");
+        free(origins);
+        free(matrix);
+        return;
+    }
+    int* destinations = origins + unitCount;
+    int valid = 1;
+    for (int i = 0; i < unitCount; i++) {
+        origins[i] = findNode(graph, units[i]);
+        if (origins[i] == -1) valid = 0;
+    }
+    for (int j = 0; j < incidentCount; j++) {
+        destinations[j] = findNode(graph, incidents[j]);
+        if (destinations[j] == -1) valid = 0;
+    }
+
+    Dispatcher dispatcher;
+    if (!valid) {
+        printf("Invalid unit or incident node.\n");
+    } else if (dispatcherInit(&dispatcher, 0) != 0) {
+        printf("Out of memory.\n");
+    } else {
+        if (travelTimeMatrix(&dispatcher, graph, origins, unitCount, destinations, incidentCount, matrix) != 0) {
+            printf("Out of memory.\n");
+        } else {
+            printf("Travel time matrix (units x incidents):\n");
+            for (int i = 0; i < unitCount; i++) {
+                printf("%s:", units[i]);
+                for (int j = 0; j < incidentCount; j++) {
+                    int time = matrix[(size_t)i * incidentCount + j];
+                    if (time == UNREACHABLE) {
+                        printf(" %s=-", incidents[j]);
+                    } else {
+                        printf(" %s=%d", incidents[j], time);
+                    }
+                }
+                printf("\n");
+            }
+        }
+        dispatcherFree(&dispatcher);
+    }
+    free(origins);
+    free(matrix);
+}
@@ -0,0 +1,57 @@
+#ifndef MATRIX_H
+#define MATRIX_H
+
+#include "graph.h"
+#include "search.h"
+#include "ch.h"
+#include "threadpool.h"
+
+#define MATRIX_ROW_CHUNK 1 // Rows a worker claims at a time; each row is a whole search
+
+// Thread pool plus one search state per worker, kept across calls so batches of
+// searches allocate nothing once the states have grown to the graph's size
+typedef struct {
+    ThreadPool pool;
+    SearchState* states;  // One per worker
+    int stateCount;
+    unsigned char* marks; // Destination flags shared read-only by the workers
+    int markCapacity;
+    const ContractionHierarchy* ch; // Optional; switches batches to bucket-based queries
+
+    // Buckets: the upward search space of every destination, grouped by node
+    int* bucketOffsets;   // Entries at node v: [bucketOffsets[v], bucketOffsets[v + 1])
+    int offsetCapacity;
+    int* bucketTarget;    // Destination position of an entry
+    int* bucketDistance;  // Travel time from the node up-and-down to that destination
+    int* entryNode;       // Entries in the order the destination searches produce them
+    int* entryTarget;
+    int* entryDistance;
+    int entryCount;
+    int entryCapacity;
+} Dispatcher;
+
+int dispatcherInit(Dispatcher* dispatcher, int threadCount);
+void dispatcherFree(Dispatcher* dispatcher);
+
+// Answer later batches through a contraction hierarchy of the graph (NULL to stop).
+// The hierarchy must stay alive while it is in use and is ignored if it does not match the graph.
+void dispatcherUseHierarchy(Dispatcher* dispatcher, const ContractionHierarchy* ch);
+
+// Travel time from every origin to every destination (node indices) into the row-major
+// originCount x destinationCount matrix, UNREACHABLE where there is no route.
+// One one-to-many search per origin, spread across the workers; with a hierarchy, one
+// upward search per destination fills buckets that the origins' upward searches scan.
+// Returns 0, or -1 on error.
+int travelTimeMatrix(Dispatcher* dispatcher, const Graph* graph, const int* origins, int originCount,
+                     const int* destinations, int destinationCount, int* matrix);
+
+// For every incident, the k closest units by travel time. Row i of nearest (incidentCount x k)
+// holds positions in units, closest first, and times holds their travel times; rows are
+// padded with -1 and UNREACHABLE when fewer than k units can reach. Returns 0, or -1 on error.
+int nearestUnits(Dispatcher* dispatcher, const Graph* graph, const int* units, int unitCount,
+                 const int* incidents, int incidentCount, int k, int* nearest, int* times);
+
+// Print the travel-time matrix between named units and incidents
+void dispatchMatrix(Graph* graph, const char** units, int unitCount, const char** incidents, int incidentCount);
+
+#endif // MATRIX_H
@@ -0,0 +1,92 @@
+#include <stdlib.h>
+#include <string.h>
+#include "names.h"
+
+// FNV-1a hash of the first length bytes of a name
+unsigned int nameHash(const char* name, size_t length) {
+    unsigned int hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char)name[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Slot holding name, or the empty slot where it would go
+static int findSlot(const NameIndex* index, const char* name, unsigned int hash) {
+    int mask = index->slotCapacity - 1;
+    int slot = (int)(hash & mask);
+    while (index->slots[slot] != -1) {
+        int node = index->slots[slot];
+        if (index->hashes[node] == hash && strcmp(index->names[node], name) == 0) {
+            return slot;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+static int growSlots(NameIndex* index, int slotCapacity) {
+    int* slots = (int*)malloc(slotCapacity * sizeof(int));
+    if (slots == NULL) return -1;
+    memset(slots, -1, slotCapacity * sizeof(int));
+    int mask = slotCapacity - 1;
+    for (int node = 0; node < index->count; node++) {
+        int slot = (int)(index->hashes[node] & mask);
+        while (slots[slot] != -1) slot = (slot + 1) & mask;
+        slots[slot] = node;
+    }
+    free(index->slots);
+    index->slots = slots;
+    index->slotCapacity = slotCapacity;
+    return 0;
+}
+
+int nameIndexInit(NameIndex* index) {
+    index->names = NULL;
+    index->hashes = NULL;
+    index->count = 0;
+    index->capacity = 0;
+    index->slots = NULL;
+    index->slotCapacity = 0;
+    return growSlots(index, INITIAL_NAME_SLOTS);
+}
+
+void nameIndexFree(NameIndex* index) {
+    free(index->names);
+    free(index->hashes);
+    free(index->slots);
+    index->names = NULL;
+    index->hashes = NULL;
+    index->slots = NULL;
+    index->count = index->capacity = index->slotCapacity = 0;
+}
+
+// Index name as the next node; returns its index, or -1 if memory runs out
+int nameIndexAdd(NameIndex* index, const char* name) {
+    if ((index->count + 1) * 2 > index->slotCapacity) {
+        if (growSlots(index, index->slotCapacity ? index->slotCapacity * 2 : INITIAL_NAME_SLOTS) != 0) return -1;
+    }
+    if (index->count == index->capacity) {
+        int capacity = index->capacity ? index->capacity * 2 : 16;
+        const char** names = (const char**)realloc(index->names, capacity * sizeof(const char*));
+        if (names == NULL) return -1;
+        index->names = names;
+        unsigned int* hashes = (unsigned int*)realloc(index->hashes, capacity * sizeof(unsigned int));
+        if (hashes == NULL) return -1;
+        index->hashes = hashes;
+        index->capacity = capacity;
+    }
+    unsigned int hash = nameHash(name, strlen(name));
+    int node = index->count++;
+    index->names[node] = name;
+    index->hashes[node] = hash;
+    index->slots[findSlot(index, name, hash)] = node;
+    return node;
+}
+
+// Node index of name, or -1
+int nameIndexFind(const NameIndex* index, const char* name) {
+    if (index->slotCapacity == 0) return -1;
+    return index->slots[findSlot(index, name, nameHash(name, strlen(name)))];
+}
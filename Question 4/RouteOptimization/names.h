@@ -0,0 +1,25 @@
+#ifndef NAMES_H
+#define NAMES_H
+
+#include <stddef.h>
+
+#define INITIAL_NAME_SLOTS 32 // Hash slots reserved by nameIndexInit (power of two)
+
+// Open-addressing hash map from junction name to node index.
+// The strings are borrowed from the graph's nodes, which never move them.
+typedef struct {
+    const char** names;   // Name per node index
+    unsigned int* hashes; // Hash per node index
+    int count;            // Names indexed
+    int capacity;         // Allocated entries in names/hashes
+    int* slots;           // Node index per slot, -1 when empty
+    int slotCapacity;     // Power of two, kept at least twice count
+} NameIndex;
+
+unsigned int nameHash(const char* name, size_t length);
+int nameIndexInit(NameIndex* index);
+void nameIndexFree(NameIndex* index);
+int nameIndexAdd(NameIndex* index, const char* name);
+int nameIndexFind(const NameIndex* index, const char* name);
+
+#endif // NAMES_H
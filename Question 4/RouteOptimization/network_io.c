@@ -0,0 +1,558 @@
+#define _DEFAULT_SOURCE // mmap flags under -std=c11
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "network_io.h"
+
+// Roads or arcs collected before they are sorted into CSR arrays
+typedef struct {
+    int* from;
+    int* to;
+    int* weight;
+    long count;
+    long capacity;
+} ArcList;
+
+void coordinatesInit(NodeCoordinates* coords) {
+    coords->x = NULL;
+    coords->y = NULL;
+    coords->count = 0;
+}
+
+void coordinatesFree(NodeCoordinates* coords) {
+    free(coords->x);
+    free(coords->y);
+    coordinatesInit(coords);
+}
+
+static int coordinatesReserve(NodeCoordinates* coords, int count) {
+    coords->x = (int*)calloc(count > 0 ? count : 1, sizeof(int));
+    coords->y = (int*)calloc(count > 0 ? count : 1, sizeof(int));
+    if (coords->x == NULL || coords->y == NULL) {
+        coordinatesFree(coords);
+        return -1;
+    }
+    coords->count = count;
+    return 0;
+}
+
+static int arcListInit(ArcList* arcs, long capacity) {
+    arcs->from = (int*)malloc((capacity > 0 ? capacity : 1) * sizeof(int));
+    arcs->to = (int*)malloc((capacity > 0 ? capacity : 1) * sizeof(int));
+    arcs->weight = (int*)malloc((capacity > 0 ? capacity : 1) * sizeof(int));
+    arcs->count = 0;
+    arcs->capacity = capacity;
+    return (arcs->from != NULL && arcs->to != NULL && arcs->weight != NULL) ? 0 : -1;
+}
+
+static void arcListFree(ArcList* arcs) {
+    free(arcs->from);
+    free(arcs->to);
+    free(arcs->weight);
+    arcs->from = arcs->to = arcs->weight = NULL;
+    arcs->count = arcs->capacity = 0;
+}
+
+// Add count nodes named prefix followed by first, first + 1, ... to the graph
+static int addNumberedNodes(Graph* graph, const char* prefix, int first, int count) {
+    char name[32];
+    for (int i = 0; i < count; i++) {
+        snprintf(name, sizeof(name), "%s%d", prefix, first + i);
+        if (addNode(graph, name) != 0) return -1;
+    }
+    return 0;
+}
+
+// Counting-sort the arcs by tail into CSR arrays and hand them to the graph. With
+// bothWays each arc is a road and also yields its reverse. Edges of a node keep list order.
+static int buildRoads(Graph* graph, const ArcList* arcs, int bothWays) {
+    int n = graph->nodeCount;
+    long edges = bothWays ? 2 * arcs->count : arcs->count;
+    if (edges >= INT_MAX) return -1;
+    int* offsets = (int*)calloc(n + 1, sizeof(int));
+    int* targets = (int*)malloc((edges + 1) * sizeof(int));
+    int* weights = (int*)malloc((edges + 1) * sizeof(int));
+    if (offsets == NULL || targets == NULL || weights == NULL) {
+        free(offsets);
+        free(targets);
+        free(weights);
+        return -1;
+    }
+
+    for (long i = 0; i < arcs->count; i++) {
+        offsets[arcs->from[i] + 1]++;
+        if (bothWays) offsets[arcs->to[i] + 1]++;
+    }
+    for (int v = 0; v < n; v++) {
+        offsets[v + 1] += offsets[v];
+    }
+    // offsets[v] serves as node v's fill cursor, ending at the start of v + 1
+    for (long i = 0; i < arcs->count; i++) {
+        int at = offsets[arcs->from[i]]++;
+        targets[at] = arcs->to[i];
+        weights[at] = arcs->weight[i];
+        if (bothWays) {
+            at = offsets[arcs->to[i]]++;
+            targets[at] = arcs->from[i];
+            weights[at] = arcs->weight[i];
+        }
+    }
+    for (int v = n; v > 0; v--) {
+        offsets[v] = offsets[v - 1];
+    }
+    offsets[0] = 0;
+
+    adoptRoads(graph, offsets, targets, weights);
+    return 0;
+}
+
+// ---- DIMACS files ----
+
+// An arc's other endpoint and weight as one sortable key
+static unsigned long long arcKey(int node, int weight) {
+    return ((unsigned long long)(unsigned int)node << 32) | (unsigned int)weight;
+}
+
+static int compareKeys(const void* a, const void* b) {
+    unsigned long long x = *(const unsigned long long*)a;
+    unsigned long long y = *(const unsigned long long*)b;
+    return (x > y) - (x < y);
+}
+
+static void sortKeys(unsigned long long* keys, int count) {
+    if (count > 16) {
+        qsort(keys, count, sizeof(unsigned long long), compareKeys);
+        return;
+    }
+    for (int i = 1; i < count; i++) {
+        unsigned long long key = keys[i];
+        int j = i;
+        while (j > 0 && keys[j - 1] > key) {
+            keys[j] = keys[j - 1];
+            j--;
+        }
+        keys[j] = key;
+    }
+}
+
+// Check that the CSR arrays hold every arc u -> v of weight w as often as v -> u of
+// weight w. The backward searches, contraction, landmarks and weight updates all read
+// a node's edges as its incoming roads too. Per node, the outgoing arcs and the arcs
+// arriving (gathered by a counting sort on the head) are compared as sorted keys.
+// Returns 1 if symmetric, 0 if not with one unmatched arc in from/to/weight, or -1 if
+// out of memory.
+static int roadsSymmetric(const Graph* graph, int* from, int* to, int* weight) {
+    int n = graph->nodeCount;
+    int maxDegree = 0;
+    int* inOffsets = (int*)calloc(n + 1, sizeof(int));
+    unsigned long long* inKeys = (unsigned long long*)malloc((graph->edgeCount + 1) * sizeof(unsigned long long));
+    if (inOffsets == NULL || inKeys == NULL) {
+        free(inOffsets);
+        free(inKeys);
+        return -1;
+    }
+    for (int e = 0; e < graph->edgeCount; e++) {
+        inOffsets[graph->targets[e] + 1]++;
+    }
+    for (int v = 0; v < n; v++) {
+        inOffsets[v + 1] += inOffsets[v];
+        int out = graph->offsets[v + 1] - graph->offsets[v];
+        if (out > maxDegree) maxDegree = out;
+    }
+    int* cursor = (int*)malloc((n + 1) * sizeof(int));
+    unsigned long long* outKeys = (unsigned long long*)malloc((maxDegree + 1) * sizeof(unsigned long long));
+    if (cursor == NULL || outKeys == NULL) {
+        free(inOffsets);
+        free(inKeys);
+        free(cursor);
+        free(outKeys);
+        return -1;
+    }
+    memcpy(cursor, inOffsets, (n + 1) * sizeof(int));
+    for (int u = 0; u < n; u++) {
+        for (int e = graph->offsets[u]; e < graph->offsets[u + 1]; e++) {
+            inKeys[cursor[graph->targets[e]]++] = arcKey(u, graph->weights[e]);
+        }
+    }
+
+    int symmetric = 1;
+    for (int v = 0; v < n && symmetric; v++) {
+        int outCount = graph->offsets[v + 1] - graph->offsets[v];
+        int inCount = inOffsets[v + 1] - inOffsets[v];
+        unsigned long long* in = inKeys + inOffsets[v];
+        for (int i = 0; i < outCount; i++) {
+            int e = graph->offsets[v] + i;
+            outKeys[i] = arcKey(graph->targets[e], graph->weights[e]);
+        }
+        sortKeys(outKeys, outCount);
+        sortKeys(in, inCount);
+
+        int i = 0;
+        while (i < outCount && i < inCount && outKeys[i] == in[i]) i++;
+        if (i < outCount && (i == inCount || outKeys[i] < in[i])) {
+            // v -> other with no way back
+            *from = v;
+            *to = (int)(outKeys[i] >> 32);
+            *weight = (int)(unsigned int)outKeys[i];
+            symmetric = 0;
+        } else if (i < inCount) {
+            // other -> v with no way back
+            *from = (int)(in[i] >> 32);
+            *to = v;
+            *weight = (int)(unsigned int)in[i];
+            symmetric = 0;
+        }
+    }
+    free(inOffsets);
+    free(inKeys);
+    free(cursor);
+    free(outKeys);
+    return symmetric;
+}
+
+// Read-only mapping of a whole file
+typedef struct {
+    const char* data;
+    size_t size;
+} MappedFile;
+
+static int mapFile(MappedFile* file, const char* path) {
+    file->data = NULL;
+    file->size = 0;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror("Could not open network file");
+        return -1;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        perror("Could not stat network file");
+        close(fd);
+        return -1;
+    }
+    if (info.st_size == 0) {
+        close(fd);
+        return 0;
+    }
+    void* data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        perror("Could not map network file");
+        return -1;
+    }
+    madvise(data, (size_t)info.st_size, MADV_SEQUENTIAL);
+    file->data = (const char*)data;
+    file->size = (size_t)info.st_size;
+    return 0;
+}
+
+static void unmapFile(MappedFile* file) {
+    if (file->data != NULL) munmap((void*)file->data, file->size);
+    file->data = NULL;
+    file->size = 0;
+}
+
+static int isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+// Parse a decimal integer after optional blanks, advancing *p past it.
+// Returns 0, or -1 if the next token before end is not a number.
+static int parseNumber(const char** p, const char* end, long long* value) {
+    const char* q = *p;
+    while (q < end && isBlank(*q)) q++;
+    int negative = 0;
+    if (q < end && *q == '-') {
+        negative = 1;
+        q++;
+    }
+    if (q == end || *q < '0' || *q > '9') return -1;
+    long long result = 0;
+    while (q < end && *q >= '0' && *q <= '9') {
+        if (result < LLONG_MAX / 10) result = result * 10 + (*q - '0');
+        q++;
+    }
+    *value = negative ? -result : result;
+    *p = q;
+    return 0;
+}
+
+// Skip blanks and one word, such as the problem type of a "p" line
+static void skipWord(const char** p, const char* end) {
+    const char* q = *p;
+    while (q < end && isBlank(*q)) q++;
+    while (q < end && !isBlank(*q)) q++;
+    *p = q;
+}
+
+long loadDimacsGraph(Graph* graph, const char* path) {
+    if (graph->nodeCount != 0) {
+        fprintf(stderr, "DIMACS graphs load into an empty graph\n");
+        return -1;
+    }
+    MappedFile file;
+    if (mapFile(&file, path) != 0) return -1;
+
+    const char* p = file.data;
+    const char* end = file.data + file.size;
+    long long nodes = -1;
+    long long declared = 0;
+    long line = 0;
+    ArcList arcs = { NULL, NULL, NULL, 0, 0 };
+    const char* error = NULL;
+    long long weightSum = 0;
+    long long maxWeight = 0;
+    long maxWeightLine = 0;
+
+    while (p < end && error == NULL) {
+        const char* lineEnd = (const char*)memchr(p, '\n', end - p);
+        if (lineEnd == NULL) lineEnd = end;
+        line++;
+        const char* q = p + 1;
+        if (*p == 'a') {
+            long long from, to, weight;
+            if (nodes < 0) {
+                error = "arc before the problem line";
+            } else if (parseNumber(&q, lineEnd, &from) != 0 || parseNumber(&q, lineEnd, &to) != 0 ||
+                       parseNumber(&q, lineEnd, &weight) != 0) {
+                error = "malformed arc";
+            } else if (from < 1 || from > nodes || to < 1 || to > nodes) {
+                error = "arc endpoint out of range";
+            } else if (weight < 0 || weight > INT_MAX) {
+                error = "arc weight out of range";
+            } else if (arcs.count == arcs.capacity) {
+                error = "more arcs than the problem line declares";
+            } else {
+                arcs.from[arcs.count] = (int)from - 1;
+                arcs.to[arcs.count] = (int)to - 1;
+                arcs.weight[arcs.count] = (int)weight;
+                arcs.count++;
+                weightSum += weight;
+                if (weight > maxWeight) {
+                    maxWeight = weight;
+                    maxWeightLine = line;
+                }
+            }
+        } else if (*p == 'p') {
+            skipWord(&q, lineEnd);
+            if (nodes >= 0) {
+                error = "second problem line";
+            } else if (parseNumber(&q, lineEnd, &nodes) != 0 || parseNumber(&q, lineEnd, &declared) != 0 ||
+                       nodes < 0 || nodes >= INT_MAX || declared < 0 || declared >= INT_MAX) {
+                error = "malformed problem line";
+            } else if (arcListInit(&arcs, (long)declared) != 0 ||
+                       addNumberedNodes(graph, "", 1, (int)nodes) != 0) {
+                error = "out of memory";
+            }
+        } else if (*p != 'c' && *p != '\n' && *p != '\r') {
+            error = "unknown line type";
+        }
+        p = lineEnd + 1;
+    }
+    if (error == NULL && nodes < 0) {
+        error = "no problem line";
+    }
+    // Searches add travel times in int, and a bidirectional search adds two tentative
+    // distances. A tentative distance is at most n times the largest weight, and at
+    // most the sum of all arc weights since every road is listed twice; either bound
+    // keeps the sum of two below UNREACHABLE.
+    if (error == NULL && maxWeight > (INT_MAX - 1) / (2 * (nodes > 1 ? nodes : 1)) &&
+        weightSum > (INT_MAX - 1) / 2) {
+        error = "arc weight out of range; route lengths could overflow int";
+        line = maxWeightLine;
+    }
+    if (error == NULL && buildRoads(graph, &arcs, 0) != 0) {
+        error = "out of memory";
+    }
+    unmapFile(&file);
+
+    long count = arcs.count;
+    arcListFree(&arcs);
+    int symmetric = 0;
+    if (error == NULL) {
+        int from, to, weight;
+        symmetric = roadsSymmetric(graph, &from, &to, &weight);
+        if (symmetric == 0) {
+            fprintf(stderr, "%s: arc %d %d %d has no reverse arc of the same weight; "
+                            "every road must be listed in both directions\n",
+                    path, from + 1, to + 1, weight);
+        } else if (symmetric < 0) {
+            fprintf(stderr, "%s: out of memory\n", path);
+        }
+    } else {
+        fprintf(stderr, "%s:%ld: %s\n", path, line, error);
+    }
+    if (symmetric != 1) {
+        // Leave the graph empty so the caller can load another file into it
+        unsigned int version = graph->version;
+        freeGraph(graph);
+        initializeGraph(graph);
+        graph->version = version + 1;
+        graph->shortenedVersion = graph->version;
+        return -1;
+    }
+    return count;
+}
+
+int loadDimacsCoordinates(NodeCoordinates* coords, const char* path, int nodeCount) {
+    MappedFile file;
+    if (mapFile(&file, path) != 0) return -1;
+    if (coordinatesReserve(coords, nodeCount) != 0) {
+        unmapFile(&file);
+        return -1;
+    }
+
+    const char* p = file.data;
+    const char* end = file.data + file.size;
+    long line = 0;
+    const char* error = NULL;
+    while (p < end && error == NULL) {
+        const char* lineEnd = (const char*)memchr(p, '\n', end - p);
+        if (lineEnd == NULL) lineEnd = end;
+        line++;
+        const char* q = p + 1;
+        if (*p == 'v') {
+            long long id, x, y;
+            if (parseNumber(&q, lineEnd, &id) != 0 || parseNumber(&q, lineEnd, &x) != 0 ||
+                parseNumber(&q, lineEnd, &y) != 0) {
+                error = "malformed coordinate";
+            } else if (id < 1 || id > nodeCount) {
+                error = "node out of range";
+            } else if (x < INT_MIN || x > INT_MAX || y < INT_MIN || y > INT_MAX) {
+                error = "coordinate out of range";
+            } else {
+                coords->x[id - 1] = (int)x;
+                coords->y[id - 1] = (int)y;
+            }
+        } else if (*p != 'c' && *p != 'p' && *p != '\n' && *p != '\r') {
+            error = "unknown line type";
+        }
+        p = lineEnd + 1;
+    }
+    unmapFile(&file);
+    if (error != NULL) {
+        fprintf(stderr, "%s:%ld: %s\n", path, line, error);
+        coordinatesFree(coords);
+        return -1;
+    }
+    return 0;
+}
+
+// ---- Synthetic networks ----
+
+// xorshift64*, so generated networks depend only on the seed and not on rand()
+static unsigned int nextRandom(unsigned long long* state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return (unsigned int)((*state * 2685821657736338717ULL) >> 32);
+}
+
+static unsigned long long seedRandom(unsigned int seed) {
+    return (seed + 1ULL) * 0x9E3779B97F4A7C15ULL | 1;
+}
+
+// Straight-line distance, rounded down
+static int lineLength(int dx, int dy) {
+    long long square = (long long)dx * dx + (long long)dy * dy;
+    if (square < 2) return (int)square;
+    long long x = square;
+    long long y = (x + 1) / 2;
+    while (y < x) {
+        x = y;
+        y = (x + square / x) / 2;
+    }
+    return (int)x;
+}
+
+static void pushArc(ArcList* arcs, int from, int to, int weight) {
+    arcs->from[arcs->count] = from;
+    arcs->to[arcs->count] = to;
+    arcs->weight[arcs->count] = weight;
+    arcs->count++;
+}
+
+int generateGrid(Graph* graph, NodeCoordinates* coords, int width, int height, int maxWeight, unsigned int seed) {
+    if (graph->nodeCount != 0 || width < 1 || height < 1 || maxWeight < 1 || (long)width * height >= INT_MAX / 2) {
+        return -1;
+    }
+    int n = width * height;
+    ArcList roads;
+    if (arcListInit(&roads, 2L * n) != 0 || addNumberedNodes(graph, "J", 0, n) != 0) {
+        arcListFree(&roads);
+        return -1;
+    }
+    unsigned long long random = seedRandom(seed);
+    for (int v = 0; v < n; v++) {
+        if (v % width + 1 < width) pushArc(&roads, v, v + 1, 1 + (int)(nextRandom(&random) % maxWeight));
+        if (v + width < n) pushArc(&roads, v, v + width, 1 + (int)(nextRandom(&random) % maxWeight));
+    }
+    int status = buildRoads(graph, &roads, 1);
+    arcListFree(&roads);
+
+    if (status == 0 && coords != NULL) {
+        status = coordinatesReserve(coords, n);
+        for (int v = 0; v < n && status == 0; v++) {
+            coords->x[v] = v % width * GRID_SPACING;
+            coords->y[v] = v / width * GRID_SPACING;
+        }
+    }
+    return status;
+}
+
+int generateRoadNetwork(Graph* graph, NodeCoordinates* coords, int nodeCount, unsigned int seed) {
+    if (graph->nodeCount != 0 || nodeCount < 1 || nodeCount >= INT_MAX / 2) return -1;
+    int width = 1;
+    while ((long)width * width < nodeCount) width++;
+
+    NodeCoordinates local;
+    coordinatesInit(&local);
+    ArcList roads;
+    if (coordinatesReserve(&local, nodeCount) != 0 || arcListInit(&roads, 2L * nodeCount) != 0 ||
+        addNumberedNodes(graph, "J", 0, nodeCount) != 0) {
+        coordinatesFree(&local);
+        arcListFree(&roads);
+        return -1;
+    }
+
+    // Junctions sit near their grid point, up to a quarter spacing off in each axis
+    unsigned long long random = seedRandom(seed);
+    for (int v = 0; v < nodeCount; v++) {
+        local.x[v] = v % width * GRID_SPACING + (int)(nextRandom(&random) % (GRID_SPACING / 2 + 1)) - GRID_SPACING / 4;
+        local.y[v] = v / width * GRID_SPACING + (int)(nextRandom(&random) % (GRID_SPACING / 2 + 1)) - GRID_SPACING / 4;
+    }
+
+    // North-south streets are all kept and row 0 is an arterial, so everything stays connected
+    for (int v = 0; v < nodeCount; v++) {
+        int row = v / width;
+        int col = v % width;
+        if (col + 1 < width && v + 1 < nodeCount) {
+            int arterial = row % ARTERIAL_EVERY == 0;
+            if (arterial || nextRandom(&random) % 100 >= LOCAL_DROP_PERCENT) {
+                int length = lineLength(local.x[v + 1] - local.x[v], local.y[v + 1] - local.y[v]);
+                int time = arterial ? length / ARTERIAL_SPEED : length;
+                pushArc(&roads, v, v + 1, time > 0 ? time : 1);
+            }
+        }
+        if (v + width < nodeCount) {
+            int arterial = col % ARTERIAL_EVERY == 0;
+            int length = lineLength(local.x[v + width] - local.x[v], local.y[v + width] - local.y[v]);
+            int time = arterial ? length / ARTERIAL_SPEED : length;
+            pushArc(&roads, v, v + width, time > 0 ? time : 1);
+        }
+    }
+    int status = buildRoads(graph, &roads, 1);
+    arcListFree(&roads);
+
+    if (status == 0 && coords != NULL) {
+        *coords = local;
+    } else {
+        coordinatesFree(&local);
+    }
+    return status;
+}
@@ -0,0 +1,49 @@
+#ifndef NETWORK_IO_H
+#define NETWORK_IO_H
+
+#include "graph.h"
+
+#define GRID_SPACING 100     // Coordinate distance between neighboring grid junctions
+#define ARTERIAL_EVERY 8     // Road-like networks: every 8th row and column is an arterial
+#define ARTERIAL_SPEED 3     // Arterials are this many times faster than local streets
+#define LOCAL_DROP_PERCENT 30 // Share of local east-west streets left out
+
+// Planar position of every node, from a DIMACS .co file or a generator
+typedef struct {
+    int* x;
+    int* y;
+    int count;
+} NodeCoordinates;
+
+void coordinatesInit(NodeCoordinates* coords);
+void coordinatesFree(NodeCoordinates* coords);
+
+// Load a DIMACS shortest-path graph ("p sp n m" header, "a u v w" arcs, "c" comments)
+// into an empty graph. Node i is named by its DIMACS ID, "1" to "n". Arcs become
+// directed CSR edges as they are. Every mode here treats a node's edges as its incoming
+// roads too, so the file must list every road in both directions with the same weight,
+// as the DIMACS road networks do; a file with a one-way arc is rejected, naming the arc.
+// Searches add travel times in int, so a file whose weights could make two route lengths
+// add up past INT_MAX (largest weight above (INT_MAX - 1) / 2n and arc weights summing
+// past (INT_MAX - 1) / 2) is rejected as out of range.
+// The graph is left finalized. Returns the number of arcs read, or -1 if the file cannot
+// be read, is malformed or is not symmetric, in which case the graph is left empty.
+long loadDimacsGraph(Graph* graph, const char* path);
+
+// Load a DIMACS coordinate file ("v id x y") for a graph of nodeCount nodes; nodes the
+// file does not mention sit at (0, 0). Returns 0, or -1 on error.
+int loadDimacsCoordinates(NodeCoordinates* coords, const char* path, int nodeCount);
+
+// Fill an empty graph with a width x height grid, node "J<row * width + col>" linked to
+// its four neighbors by roads of random travel time 1 to maxWeight. coords may be NULL.
+// The graph is left finalized. Returns 0, or -1 on error.
+int generateGrid(Graph* graph, NodeCoordinates* coords, int width, int height, int maxWeight, unsigned int seed);
+
+// Fill an empty graph with a road-like network of nodeCount junctions: jittered grid
+// positions, fast arterials every ARTERIAL_EVERY rows and columns, and local streets
+// with some east-west links missing. Travel times follow distance and speed, so the
+// network has the hierarchy real roads have. Every junction is reachable. coords may be
+// NULL. The graph is left finalized. Returns 0, or -1 on error.
+int generateRoadNetwork(Graph* graph, NodeCoordinates* coords, int nodeCount, unsigned int seed);
+
+#endif // NETWORK_IO_H
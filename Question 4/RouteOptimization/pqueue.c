@@ -0,0 +1,222 @@
+#include <stdlib.h>
+#include <string.h>
+#include "pqueue.h"
+
+int pqInit(PriorityQueue* queue, QueueKind kind, int capacity) {
+    memset(queue, 0, sizeof(*queue));
+    queue->kind = kind;
+    return pqReserve(queue, capacity);
+}
+
+// Grow the node handle range; queued entries are kept
+int pqReserve(PriorityQueue* queue, int capacity) {
+    if (capacity <= queue->capacity) return 0;
+    int* keys = (int*)realloc(queue->keys, capacity * sizeof(int));
+    if (keys == NULL) return -1;
+    queue->keys = keys;
+    int* position = (int*)realloc(queue->position, capacity * sizeof(int));
+    if (position == NULL) return -1;
+    queue->position = position;
+    if (queue->kind == QUEUE_FOUR_ARY) {
+        int* heap = (int*)realloc(queue->heap, capacity * sizeof(int));
+        if (heap == NULL) return -1;
+        queue->heap = heap;
+    }
+    for (int v = queue->capacity; v < capacity; v++) {
+        position[v] = -1;
+    }
+    queue->capacity = capacity;
+    return 0;
+}
+
+void pqFree(PriorityQueue* queue) {
+    free(queue->keys);
+    free(queue->position);
+    free(queue->heap);
+    for (int b = 0; b < RADIX_BUCKETS; b++) {
+        free(queue->buckets[b].entries);
+    }
+    memset(queue, 0, sizeof(*queue));
+}
+
+// Empty the queue in time proportional to what is still queued
+void pqClear(PriorityQueue* queue) {
+    if (queue->kind == QUEUE_FOUR_ARY) {
+        for (int i = 0; i < queue->size; i++) {
+            queue->position[queue->heap[i]] = -1;
+        }
+    } else {
+        for (int b = 0; b < RADIX_BUCKETS; b++) {
+            RadixBucket* bucket = &queue->buckets[b];
+            for (int i = 0; i < bucket->count; i++) {
+                queue->position[bucket->entries[i].node] = -1;
+            }
+            bucket->count = 0;
+        }
+        queue->last = 0;
+    }
+    queue->size = 0;
+}
+
+int pqEmpty(const PriorityQueue* queue) {
+    return queue->size == 0;
+}
+
+int pqContains(const PriorityQueue* queue, int node) {
+    return queue->position[node] != -1;
+}
+
+// ---- 4-ary heap ----
+
+static void heapPlace(PriorityQueue* queue, int index, int node) {
+    queue->heap[index] = node;
+    queue->position[node] = index;
+}
+
+static void siftUp(PriorityQueue* queue, int index) {
+    int node = queue->heap[index];
+    int key = queue->keys[node];
+    while (index > 0) {
+        int parent = (index - 1) / HEAP_ARITY;
+        if (queue->keys[queue->heap[parent]] <= key) break;
+        heapPlace(queue, index, queue->heap[parent]);
+        index = parent;
+    }
+    heapPlace(queue, index, node);
+}
+
+static void siftDown(PriorityQueue* queue, int index) {
+    int node = queue->heap[index];
+    int key = queue->keys[node];
+    for (;;) {
+        int first = index * HEAP_ARITY + 1;
+        if (first >= queue->size) break;
+        int last = first + HEAP_ARITY < queue->size ? first + HEAP_ARITY : queue->size;
+        int best = first;
+        for (int child = first + 1; child < last; child++) {
+            if (queue->keys[queue->heap[child]] < queue->keys[queue->heap[best]]) best = child;
+        }
+        if (queue->keys[queue->heap[best]] >= key) break;
+        heapPlace(queue, index, queue->heap[best]);
+        index = best;
+    }
+    heapPlace(queue, index, node);
+}
+
+// ---- Radix heap ----
+
+// Bucket of a key relative to the last key popped (key >= last)
+static int radixBucket(int key, int last) {
+    unsigned int diff = (unsigned int)key ^ (unsigned int)last;
+    return diff ? 32 - __builtin_clz(diff) : 0;
+}
+
+static int radixAppend(RadixBucket* bucket, int node, int key) {
+    if (bucket->count == bucket->capacity) {
+        int capacity = bucket->capacity ? bucket->capacity * 2 : 64;
+        QueueEntry* entries = (QueueEntry*)realloc(bucket->entries, capacity * sizeof(QueueEntry));
+        if (entries == NULL) return -1;
+        bucket->entries = entries;
+        bucket->capacity = capacity;
+    }
+    bucket->entries[bucket->count].node = node;
+    bucket->entries[bucket->count].key = key;
+    bucket->count++;
+    return 0;
+}
+
+// Entries superseded by a decrease-key stay in their bucket and are skipped here
+static int radixLive(const PriorityQueue* queue, const QueueEntry* entry) {
+    return queue->position[entry->node] != -1 && queue->keys[entry->node] == entry->key;
+}
+
+static int radixPop(PriorityQueue* queue, int* key) {
+    RadixBucket* first = &queue->buckets[0];
+    while (first->count > 0 || queue->size > 0) {
+        while (first->count > 0) {
+            QueueEntry entry = first->entries[--first->count];
+            if (!radixLive(queue, &entry)) continue;
+            queue->position[entry.node] = -1;
+            queue->size--;
+            *key = entry.key;
+            return entry.node;
+        }
+        if (queue->size == 0) break;
+
+        // Refill bucket 0: the smallest live key in the first non-empty bucket
+        // becomes last, and every entry there moves to a strictly lower bucket
+        int b = 1;
+        int minKey = -1;
+        for (; b < RADIX_BUCKETS; b++) {
+            RadixBucket* bucket = &queue->buckets[b];
+            for (int i = 0; i < bucket->count; i++) {
+                if (radixLive(queue, &bucket->entries[i]) &&
+                    (minKey == -1 || bucket->entries[i].key < minKey)) {
+                    minKey = bucket->entries[i].key;
+                }
+            }
+            if (minKey != -1) break;
+            bucket->count = 0; // Only stale entries
+        }
+        if (minKey == -1) break;
+        queue->last = minKey;
+        RadixBucket* source = &queue->buckets[b];
+        for (int i = 0; i < source->count; i++) {
+            QueueEntry entry = source->entries[i];
+            if (!radixLive(queue, &entry)) continue;
+            if (radixAppend(&queue->buckets[radixBucket(entry.key, minKey)], entry.node, entry.key) != 0) {
+                return -1;
+            }
+        }
+        source->count = 0;
+    }
+    return -1;
+}
+
+// Insert node, or lower its key if it is already queued with a larger one.
+// Radix heaps require key >= the last key popped. Returns 0, or -1 if memory runs out.
+int pqPush(PriorityQueue* queue, int node, int key) {
+    int queued = queue->position[node] != -1;
+    if (queued && queue->keys[node] <= key) return 0;
+    queue->keys[node] = key;
+
+    if (queue->kind == QUEUE_FOUR_ARY) {
+        if (!queued) {
+            heapPlace(queue, queue->size++, node);
+        }
+        siftUp(queue, queue->position[node]);
+        return 0;
+    }
+    if (radixAppend(&queue->buckets[radixBucket(key, queue->last)], node, key) != 0) {
+        if (!queued) queue->position[node] = -1;
+        return -1;
+    }
+    if (!queued) {
+        queue->position[node] = 1;
+        queue->size++;
+    }
+    return 0;
+}
+
+// Remove the node with the smallest key; returns -1 when the queue is empty
+// (or, for a radix heap, if a bucket cannot grow while redistributing)
+int pqPop(PriorityQueue* queue, int* key) {
+    if (queue->size == 0) return -1;
+    if (queue->kind == QUEUE_RADIX) return radixPop(queue, key);
+
+    int node = queue->heap[0];
+    *key = queue->keys[node];
+    queue->position[node] = -1;
+    if (--queue->size > 0) {
+        heapPlace(queue, 0, queue->heap[queue->size]);
+        siftDown(queue, 0);
+    }
+    return node;
+}
+
+// Smallest node without removing it (4-ary heap only); -1 when empty
+int pqPeek(const PriorityQueue* queue, int* key) {
+    if (queue->size == 0 || queue->kind != QUEUE_FOUR_ARY) return -1;
+    *key = queue->keys[queue->heap[0]];
+    return queue->heap[0];
+}
@@ -0,0 +1,45 @@
+#ifndef PQUEUE_H
+#define PQUEUE_H
+
+#define HEAP_ARITY 4     // Children per heap node
+#define RADIX_BUCKETS 33 // One per bit of an int key, plus the bucket for key == last
+
+typedef enum {
+    QUEUE_FOUR_ARY, // Addressable 4-ary heap with decrease-key
+    QUEUE_RADIX     // Radix heap: monotone non-negative integer keys only
+} QueueKind;
+
+typedef struct {
+    int node;
+    int key;
+} QueueEntry;
+
+typedef struct {
+    QueueEntry* entries;
+    int count;
+    int capacity;
+} RadixBucket;
+
+// Min-priority queue over node handles 0..capacity-1, one entry per node
+typedef struct {
+    QueueKind kind;
+    int capacity;       // Node handles supported
+    int* keys;          // Current key per queued node
+    int* position;      // Heap index per node (4-ary), 1 if queued (radix); -1 when absent
+    int size;           // Queued nodes
+    int* heap;          // 4-ary: node handles in heap order
+    RadixBucket buckets[RADIX_BUCKETS]; // Radix: bucket i holds keys whose highest bit differing from last is i - 1
+    int last;           // Radix: last key popped
+} PriorityQueue;
+
+int pqInit(PriorityQueue* queue, QueueKind kind, int capacity);
+int pqReserve(PriorityQueue* queue, int capacity);
+void pqFree(PriorityQueue* queue);
+void pqClear(PriorityQueue* queue);
+int pqEmpty(const PriorityQueue* queue);
+int pqContains(const PriorityQueue* queue, int node);
+int pqPush(PriorityQueue* queue, int node, int key);
+int pqPop(PriorityQueue* queue, int* key);
+int pqPeek(const PriorityQueue* queue, int* key);
+
+#endif // PQUEUE_H
@@ -0,0 +1,236 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "route.h"
+
+void routeInit(Route* route, int* nodes, int* legTimes, int capacity) {
+    route->nodes = nodes;
+    route->legTimes = legTimes;
+    route->capacity = capacity;
+    route->length = 0;
+    route->totalTime = UNREACHABLE;
+}
+
+// Read the route to destination out of a finished search
+static void fillRoute(const SearchState* state, int destination, Route* route) {
+    route->length = 0;
+    route->totalTime = searchDistance(state, destination);
+    if (route->totalTime == UNREACHABLE) return;
+
+    for (int at = destination; at != -1; at = searchPrevious(state, at)) {
+        route->length++;
+    }
+    // Walk the predecessors back from the destination, filling the buffers from the end.
+    // A leg's time is the distance gained across it.
+    int index = route->length - 1;
+    for (int at = destination; at != -1; at = searchPrevious(state, at), index--) {
+        if (index < route->capacity) route->nodes[index] = at;
+        int previous = searchPrevious(state, at);
+        if (previous != -1 && route->legTimes != NULL && index - 1 < route->capacity - 1) {
+            route->legTimes[index - 1] = searchDistance(state, at) - searchDistance(state, previous);
+        }
+    }
+}
+
+int findRoute(const Graph* graph, SearchState* state, int origin, int destination, Route* route) {
+    if (origin < 0 || origin >= graph->nodeCount || destination < 0 || destination >= graph->nodeCount) return -1;
+    if (dijkstraSearch(graph, state, origin, destination) < 0) return -1;
+    fillRoute(state, destination, route);
+    return 0;
+}
+
+void printRoute(const Graph* graph, const Route* route) {
+    if (route->totalTime == UNREACHABLE) {
+        printf("No route.\n");
+        return;
+    }
+    int shown = (route->length < route->capacity) ? route->length : route->capacity;
+    for (int i = 0; i < shown; i++) {
+        printf("%s", graph->nodes[route->nodes[i]].name);
+        if (i + 1 < shown) {
+            if (route->legTimes != NULL) {
+                printf(" -(%d)-> ", route->legTimes[i]);
+            } else {
+                printf(" -> ");
+            }
+        }
+    }
+    if (shown < route->length) printf(" ... (%d more)", route->length - shown);
+    printf("\nTotal travel time: %d\n", route->totalTime);
+}
+
+// ---- Cache ----
+
+static unsigned int routeHash(int origin, int destination, unsigned int version) {
+    unsigned int hash = 2166136261u;
+    unsigned int words[3] = { (unsigned int)origin, (unsigned int)destination, version };
+    for (int i = 0; i < 3; i++) {
+        hash ^= words[i];
+        hash *= 16777619u;
+        hash ^= hash >> 15;
+    }
+    return hash;
+}
+
+int routeCacheInit(RouteCache* cache, int capacity) {
+    if (capacity <= 0) capacity = DEFAULT_ROUTE_CACHE_SIZE;
+    cache->count = 0;
+    cache->capacity = capacity;
+    cache->newest = cache->oldest = -1;
+    cache->hits = cache->misses = 0;
+    cache->slotCapacity = 1;
+    while (cache->slotCapacity < 2 * capacity) cache->slotCapacity *= 2; // At most half full
+    cache->entries = (RouteEntry*)calloc(capacity, sizeof(RouteEntry));
+    cache->slots = (int*)malloc(cache->slotCapacity * sizeof(int));
+    if (cache->entries == NULL || cache->slots == NULL || searchStateInit(&cache->search, 0, QUEUE_FOUR_ARY) != 0) {
+        free(cache->entries);
+        free(cache->slots);
+        cache->entries = NULL;
+        cache->slots = NULL;
+        return -1;
+    }
+    memset(cache->slots, -1, cache->slotCapacity * sizeof(int));
+    return 0;
+}
+
+void routeCacheFree(RouteCache* cache) {
+    for (int i = 0; i < cache->count; i++) {
+        free(cache->entries[i].nodes);
+        free(cache->entries[i].legTimes);
+    }
+    free(cache->entries);
+    free(cache->slots);
+    searchStateFree(&cache->search);
+    cache->entries = NULL;
+    cache->slots = NULL;
+    cache->count = cache->capacity = cache->slotCapacity = 0;
+}
+
+// Slot holding the key, or the empty slot where it would go
+static int findSlot(const RouteCache* cache, int origin, int destination, unsigned int version, unsigned int hash) {
+    int mask = cache->slotCapacity - 1;
+    int slot = (int)(hash & mask);
+    while (cache->slots[slot] != -1) {
+        const RouteEntry* entry = &cache->entries[cache->slots[slot]];
+        if (entry->hash == hash && entry->origin == origin && entry->destination == destination &&
+            entry->version == version) {
+            return slot;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+// Empty a slot and pull later probe-chain entries back so lookups never skip a gap
+static void deleteSlot(RouteCache* cache, int slot) {
+    int mask = cache->slotCapacity - 1;
+    int hole = slot;
+    int next = slot;
+    for (;;) {
+        next = (next + 1) & mask;
+        if (cache->slots[next] == -1) break;
+        int home = (int)(cache->entries[cache->slots[next]].hash & mask);
+        // Leave the entry if its home lies cyclically in (hole, next]
+        int stays = (hole <= next) ? (hole < home && home <= next) : (hole < home || home <= next);
+        if (!stays) {
+            cache->slots[hole] = cache->slots[next];
+            hole = next;
+        }
+    }
+    cache->slots[hole] = -1;
+}
+
+static void unlinkEntry(RouteCache* cache, int index) {
+    RouteEntry* entry = &cache->entries[index];
+    if (entry->newer != -1) {
+        cache->entries[entry->newer].older = entry->older;
+    } else {
+        cache->newest = entry->older;
+    }
+    if (entry->older != -1) {
+        cache->entries[entry->older].newer = entry->newer;
+    } else {
+        cache->oldest = entry->newer;
+    }
+}
+
+static void linkNewest(RouteCache* cache, int index) {
+    RouteEntry* entry = &cache->entries[index];
+    entry->newer = -1;
+    entry->older = cache->newest;
+    if (cache->newest != -1) cache->entries[cache->newest].newer = index;
+    cache->newest = index;
+    if (cache->oldest == -1) cache->oldest = index;
+}
+
+// Copy a cached route into the caller's buffers
+static void copyOut(const RouteEntry* entry, Route* route) {
+    route->length = entry->length;
+    route->totalTime = entry->totalTime;
+    int count = (entry->length < route->capacity) ? entry->length : route->capacity;
+    if (count > 0) memcpy(route->nodes, entry->nodes, count * sizeof(int));
+    if (route->legTimes != NULL && count > 1) memcpy(route->legTimes, entry->legTimes, (count - 1) * sizeof(int));
+}
+
+// Take a free entry, or evict the least recently used one
+static int claimEntry(RouteCache* cache) {
+    if (cache->count < cache->capacity) {
+        int index = cache->count++;
+        cache->entries[index].nodes = NULL;
+        cache->entries[index].legTimes = NULL;
+        return index;
+    }
+    int index = cache->oldest;
+    RouteEntry* entry = &cache->entries[index];
+    deleteSlot(cache, findSlot(cache, entry->origin, entry->destination, entry->version, entry->hash));
+    unlinkEntry(cache, index);
+    return index;
+}
+
+int routeCacheQuery(RouteCache* cache, const Graph* graph, int origin, int destination, Route* route) {
+    unsigned int hash = routeHash(origin, destination, graph->version);
+    int slot = findSlot(cache, origin, destination, graph->version, hash);
+    if (cache->slots[slot] != -1) {
+        int index = cache->slots[slot];
+        unlinkEntry(cache, index);
+        linkNewest(cache, index);
+        copyOut(&cache->entries[index], route);
+        cache->hits++;
+        return 0;
+    }
+
+    // Miss: search, size the route, then keep an exact-length copy
+    cache->misses++;
+    if (origin < 0 || origin >= graph->nodeCount || destination < 0 || destination >= graph->nodeCount) return -1;
+    if (dijkstraSearch(graph, &cache->search, origin, destination) < 0) return -1;
+    Route probe;
+    routeInit(&probe, NULL, NULL, 0);
+    fillRoute(&cache->search, destination, &probe);
+    int* nodes = (int*)malloc((probe.length + 1) * sizeof(int));
+    int* legTimes = (int*)malloc((probe.length + 1) * sizeof(int));
+    if (nodes == NULL || legTimes == NULL) {
+        free(nodes);
+        free(legTimes);
+        return -1;
+    }
+    Route full;
+    routeInit(&full, nodes, legTimes, probe.length);
+    fillRoute(&cache->search, destination, &full);
+
+    int index = claimEntry(cache);
+    RouteEntry* entry = &cache->entries[index];
+    free(entry->nodes);
+    free(entry->legTimes);
+    entry->origin = origin;
+    entry->destination = destination;
+    entry->version = graph->version;
+    entry->hash = hash;
+    entry->length = full.length;
+    entry->totalTime = full.totalTime;
+    entry->nodes = nodes;
+    entry->legTimes = legTimes;
+    cache->slots[findSlot(cache, origin, destination, graph->version, hash)] = index;
+    linkNewest(cache, index);
+    copyOut(entry, route);
+    return 0;
+}
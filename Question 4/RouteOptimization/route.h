@@ -0,0 +1,62 @@
+#ifndef ROUTE_H
+#define ROUTE_H
+
+#include "graph.h"
+#include "search.h"
+
+#define DEFAULT_ROUTE_CACHE_SIZE 1024 // Routes a cache keeps when the caller has no better figure
+
+// Result of a route query, written into buffers the caller owns
+typedef struct {
+    int* nodes;          // Junctions from origin to destination
+    int* legTimes;       // legTimes[i]: travel time from nodes[i] to nodes[i + 1]
+    int capacity;        // Slots in nodes; legTimes has room for capacity - 1
+    int length;          // Junctions on the full route; only the first capacity are written
+    int totalTime;       // UNREACHABLE if there is no route
+} Route;
+
+// Point a route at caller buffers (legTimes may be NULL if leg times are not wanted)
+void routeInit(Route* route, int* nodes, int* legTimes, int capacity);
+
+// Shortest route by node index. Returns 0 (also when there is no route), or -1 on error.
+int findRoute(const Graph* graph, SearchState* state, int origin, int destination, Route* route);
+
+// Print a route origin first, with the time of every leg
+void printRoute(const Graph* graph, const Route* route);
+
+// One cached route; the cache owns its arrays
+typedef struct {
+    int origin;
+    int destination;
+    unsigned int version; // Graph version the route was computed at
+    unsigned int hash;
+    int length;
+    int totalTime;
+    int* nodes;
+    int* legTimes;
+    int newer;           // LRU neighbors (entry indices, -1 at the ends)
+    int older;
+} RouteEntry;
+
+// Bounded LRU cache of routes keyed by (origin, destination, graph version). Any change
+// to the graph bumps its version, so older routes stop matching and age out.
+typedef struct {
+    RouteEntry* entries;
+    int count;
+    int capacity;
+    int* slots;          // Open-addressing table of entry indices, -1 when empty
+    int slotCapacity;
+    int newest;          // Most recently used entry
+    int oldest;          // Next to be evicted
+    SearchState search;  // For misses
+    long hits;
+    long misses;
+} RouteCache;
+
+int routeCacheInit(RouteCache* cache, int capacity);
+void routeCacheFree(RouteCache* cache);
+
+// Fill route from the cache, or search and remember the result. Returns 0, or -1 on error.
+int routeCacheQuery(RouteCache* cache, const Graph* graph, int origin, int destination, Route* route);
+
+#endif // ROUTE_H
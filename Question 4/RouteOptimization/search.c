@@ -0,0 +1,207 @@
+#include <stdlib.h>
+#include <string.h>
+#include "search.h"
+
+int searchStateInit(SearchState* state, int capacity, QueueKind kind) {
+    state->distance = NULL;
+    state->previous = NULL;
+    state->stamp = NULL;
+    state->current = 0;
+    state->capacity = 0;
+    state->settled = 0;
+    if (pqInit(&state->queue, kind, 0) != 0 || searchStateReserve(state, capacity) != 0) {
+        searchStateFree(state);
+        return -1;
+    }
+    return 0;
+}
+
+// Make room for capacity nodes, e.g. after the graph grew
+int searchStateReserve(SearchState* state, int capacity) {
+    if (capacity <= state->capacity) return 0;
+    int* distance = (int*)realloc(state->distance, capacity * sizeof(int));
+    if (distance == NULL) return -1;
+    state->distance = distance;
+    int* previous = (int*)realloc(state->previous, capacity * sizeof(int));
+    if (previous == NULL) return -1;
+    state->previous = previous;
+    unsigned int* stamp = (unsigned int*)realloc(state->stamp, capacity * sizeof(unsigned int));
+    if (stamp == NULL) return -1;
+    state->stamp = stamp;
+    memset(stamp + state->capacity, 0, (capacity - state->capacity) * sizeof(unsigned int));
+    if (pqReserve(&state->queue, capacity) != 0) return -1;
+    state->capacity = capacity;
+    return 0;
+}
+
+void searchStateFree(SearchState* state) {
+    free(state->distance);
+    free(state->previous);
+    free(state->stamp);
+    pqFree(&state->queue);
+    state->distance = NULL;
+    state->previous = NULL;
+    state->stamp = NULL;
+    state->capacity = 0;
+}
+
+// Forget the previous search in O(1)
+void searchReset(SearchState* state) {
+    if (++state->current == 0) {
+        memset(state->stamp, 0, state->capacity * sizeof(unsigned int));
+        state->current = 1;
+    }
+    pqClear(&state->queue);
+    state->settled = 0;
+}
+
+int searchDistance(const SearchState* state, int node) {
+    return state->stamp[node] == state->current ? state->distance[node] : UNREACHABLE;
+}
+
+int searchPrevious(const SearchState* state, int node) {
+    return state->stamp[node] == state->current ? state->previous[node] : -1;
+}
+
+// Set a node's tentative distance and predecessor for the running search
+void searchRecord(SearchState* state, int node, int distance, int previous) {
+    state->stamp[node] = state->current;
+    state->distance[node] = distance;
+    state->previous[node] = previous;
+}
+
+int dijkstraSearch(const Graph* graph, SearchState* state, int source, int target) {
+    if (!graph->finalized) return -1;
+    if (searchStateReserve(state, graph->nodeCount) != 0) return -1;
+    searchReset(state);
+    searchRecord(state, source, 0, -1);
+    if (pqPush(&state->queue, source, 0) != 0) return -1;
+
+    int distance;
+    int node;
+    while ((node = pqPop(&state->queue, &distance)) != -1) {
+        state->settled++;
+        if (node == target) break; // Settled: its distance is final
+
+        // Sequential scan over the node's slice of the CSR arrays
+        for (int e = graph->offsets[node]; e < graph->offsets[node + 1]; e++) {
+            int next = graph->targets[e];
+            int candidate = distance + graph->weights[e];
+            if (candidate < searchDistance(state, next)) {
+                searchRecord(state, next, candidate, node);
+                if (pqPush(&state->queue, next, candidate) != 0) return -1;
+            }
+        }
+    }
+    return (target >= 0) ? searchDistance(state, target) : 0;
+}
+
+int dijkstraSearchSet(const Graph* graph, SearchState* state, int source, const unsigned char* isTarget,
+                      int targetCount) {
+    if (!graph->finalized) return -1;
+    if (searchStateReserve(state, graph->nodeCount) != 0) return -1;
+    searchReset(state);
+    searchRecord(state, source, 0, -1);
+    if (pqPush(&state->queue, source, 0) != 0) return -1;
+
+    int remaining = targetCount;
+    int distance;
+    int node;
+    while (remaining > 0 && (node = pqPop(&state->queue, &distance)) != -1) {
+        state->settled++;
+        if (isTarget[node]) remaining--;
+
+        for (int e = graph->offsets[node]; e < graph->offsets[node + 1]; e++) {
+            int next = graph->targets[e];
+            int candidate = distance + graph->weights[e];
+            if (candidate < searchDistance(state, next)) {
+                searchRecord(state, next, candidate, node);
+                if (pqPush(&state->queue, next, candidate) != 0) return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+// Settle the next node of one direction and relax its roads, keeping the best route
+// through any node the other direction has reached. Returns 0 once the queue is empty.
+static int bidirectionalStep(const Graph* graph, SearchState* state, const SearchState* other, int* lastKey,
+                             int* best, int* meeting) {
+    int node = pqPop(&state->queue, lastKey);
+    if (node == -1) return 0;
+    state->settled++;
+
+    for (int e = graph->offsets[node]; e < graph->offsets[node + 1]; e++) {
+        int next = graph->targets[e];
+        int candidate = *lastKey + graph->weights[e];
+        if (candidate < searchDistance(state, next)) {
+            searchRecord(state, next, candidate, node);
+            if (pqPush(&state->queue, next, candidate) != 0) return -1;
+
+            int rest = searchDistance(other, next);
+            if (rest != UNREACHABLE && candidate + rest < *best) {
+                *best = candidate + rest;
+                *meeting = next;
+            }
+        }
+    }
+    return 1;
+}
+
+int bidirectionalSearch(const Graph* graph, SearchState* forward, SearchState* backward, int source, int target,
+                        int* meeting) {
+    *meeting = -1;
+    if (!graph->finalized) return -1;
+    if (searchStateReserve(forward, graph->nodeCount) != 0 || searchStateReserve(backward, graph->nodeCount) != 0) {
+        return -1;
+    }
+    searchReset(forward);
+    searchReset(backward);
+    searchRecord(forward, source, 0, -1);
+    searchRecord(backward, target, 0, -1);
+    if (pqPush(&forward->queue, source, 0) != 0 || pqPush(&backward->queue, target, 0) != 0) return -1;
+
+    int best = UNREACHABLE;
+    if (source == target) {
+        best = 0;
+        *meeting = source;
+    }
+
+    // Alternate directions. Every node still queued in a direction lies at least as far
+    // as the key it last popped, so once the two last keys add up to the best route
+    // found, no route through an unsettled node can be shorter. An empty queue means
+    // that side of the network is exhausted and every route through it has been seen.
+    int lastForward = 0;
+    int lastBackward = 0;
+    int turn = 0;
+    while (best == UNREACHABLE || lastForward + lastBackward < best) {
+        int stepped = (turn == 0) ? bidirectionalStep(graph, forward, backward, &lastForward, &best, meeting)
+                                  : bidirectionalStep(graph, backward, forward, &lastBackward, &best, meeting);
+        if (stepped < 0) return -1;
+        if (stepped == 0) break;
+        turn ^= 1;
+    }
+    return best;
+}
+
+int bidirectionalPath(const SearchState* forward, const SearchState* backward, int meeting, int* path, int capacity) {
+    if (meeting < 0) return 0;
+
+    // Forward predecessors lead from the meeting node back to the source
+    int length = 0;
+    for (int at = meeting; at != -1; at = searchPrevious(forward, at)) {
+        length++;
+    }
+    int index = length;
+    for (int at = meeting; at != -1; at = searchPrevious(forward, at)) {
+        index--;
+        if (index < capacity) path[index] = at;
+    }
+
+    // Backward predecessors lead from the meeting node on to the target
+    for (int at = searchPrevious(backward, meeting); at != -1; at = searchPrevious(backward, at)) {
+        if (length < capacity) path[length] = at;
+        length++;
+    }
+    return length;
+}
@@ -0,0 +1,54 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include "graph.h"
+#include "pqueue.h"
+
+#define UNREACHABLE INT_MAX // Distance of a node the search has not reached
+
+// Per-search working arrays, reused across queries so a search allocates nothing.
+// A node's distance and predecessor are valid only if its stamp matches current,
+// so starting a search costs O(1) instead of clearing every array.
+typedef struct {
+    int* distance;         // Tentative travel time from the source
+    int* previous;         // Predecessor on the shortest path, -1 at the source
+    unsigned int* stamp;   // Search that last wrote each node
+    unsigned int current;  // Stamp of the running search
+    int capacity;          // Node slots allocated
+    PriorityQueue queue;
+    int settled;           // Nodes settled by the last search
+} SearchState;
+
+int searchStateInit(SearchState* state, int capacity, QueueKind kind);
+int searchStateReserve(SearchState* state, int capacity);
+void searchStateFree(SearchState* state);
+void searchReset(SearchState* state);
+int searchDistance(const SearchState* state, int node);
+int searchPrevious(const SearchState* state, int node);
+void searchRecord(SearchState* state, int node, int distance, int previous);
+
+// Searches run on the CSR arrays and return -1 unless the graph is finalized.
+
+// Dijkstra from source. With target >= 0 the search stops once target is settled and
+// returns its distance (UNREACHABLE if there is no path); with target == -1 it settles
+// every reachable node and returns 0. Returns -1 if memory runs out.
+int dijkstraSearch(const Graph* graph, SearchState* state, int source, int target);
+
+// One-to-many Dijkstra from source that stops once targetCount nodes flagged in
+// isTarget are settled (or the reachable network is exhausted). isTarget is only
+// read, so concurrent searches may share it. Returns 0, or -1 on error.
+int dijkstraSearchSet(const Graph* graph, SearchState* state, int source, const unsigned char* isTarget,
+                      int targetCount);
+
+// Bidirectional Dijkstra between source and target: forward grows from source, backward
+// from target (roads are symmetric, so both scan the same CSR arrays). Returns the
+// travel time, UNREACHABLE if there is no path, or -1 on error, and sets *meeting to
+// the node where the two halves of the route join (-1 if there is none).
+int bidirectionalSearch(const Graph* graph, SearchState* forward, SearchState* backward, int source, int target,
+                        int* meeting);
+
+// Route of the last bidirectionalSearch, source first. Writes up to capacity nodes into
+// path and returns the full length (0 if there is no route).
+int bidirectionalPath(const SearchState* forward, const SearchState* backward, int meeting, int* path, int capacity);
+
+#endif // SEARCH_H
@@ -0,0 +1,249 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "trees.h"
+
+int treeCacheInit(TreeCache* cache) {
+    cache->trees = NULL;
+    cache->count = 0;
+    cache->capacity = 0;
+    cache->nodeCount = 0;
+    cache->version = 0;
+    cache->mark = NULL;
+    cache->stamp = 0;
+    cache->stack = NULL;
+    cache->touched = 0;
+    if (searchStateInit(&cache->search, 0, QUEUE_FOUR_ARY) != 0) return -1;
+    if (pqInit(&cache->queue, QUEUE_FOUR_ARY, 0) != 0) {
+        searchStateFree(&cache->search);
+        return -1;
+    }
+    return 0;
+}
+
+void treeCacheFree(TreeCache* cache) {
+    for (int i = 0; i < cache->count; i++) {
+        free(cache->trees[i].distance);
+        free(cache->trees[i].previous);
+    }
+    free(cache->trees);
+    free(cache->mark);
+    free(cache->stack);
+    searchStateFree(&cache->search);
+    pqFree(&cache->queue);
+    cache->trees = NULL;
+    cache->mark = NULL;
+    cache->stack = NULL;
+    cache->count = cache->capacity = cache->nodeCount = 0;
+}
+
+// Size every per-node array for the graph's current node count
+static int reserveNodes(TreeCache* cache, int nodeCount) {
+    if (nodeCount <= cache->nodeCount) return 0;
+    for (int i = 0; i < cache->count; i++) {
+        int* distance = (int*)realloc(cache->trees[i].distance, nodeCount * sizeof(int));
+        if (distance == NULL) return -1;
+        cache->trees[i].distance = distance;
+        int* previous = (int*)realloc(cache->trees[i].previous, nodeCount * sizeof(int));
+        if (previous == NULL) return -1;
+        cache->trees[i].previous = previous;
+    }
+    unsigned int* mark = (unsigned int*)realloc(cache->mark, nodeCount * sizeof(unsigned int));
+    if (mark == NULL) return -1;
+    memset(mark + cache->nodeCount, 0, (nodeCount - cache->nodeCount) * sizeof(unsigned int));
+    cache->mark = mark;
+    int* stack = (int*)realloc(cache->stack, nodeCount * sizeof(int));
+    if (stack == NULL) return -1;
+    cache->stack = stack;
+    if (pqReserve(&cache->queue, nodeCount) != 0) return -1;
+    cache->nodeCount = nodeCount;
+    return 0;
+}
+
+// Full Dijkstra from the tree's origin, copied out of the shared search state
+static int computeTree(TreeCache* cache, const Graph* graph, CachedTree* tree) {
+    if (dijkstraSearch(graph, &cache->search, tree->origin, -1) != 0) return -1;
+    for (int v = 0; v < graph->nodeCount; v++) {
+        tree->distance[v] = searchDistance(&cache->search, v);
+        tree->previous[v] = searchPrevious(&cache->search, v);
+    }
+    return 0;
+}
+
+// Recompute every tree, after changes the repair does not handle
+static int refreshTrees(TreeCache* cache, const Graph* graph) {
+    if (!graph->finalized || reserveNodes(cache, graph->nodeCount) != 0) return -1;
+    for (int i = 0; i < cache->count; i++) {
+        if (computeTree(cache, graph, &cache->trees[i]) != 0) return -1;
+    }
+    cache->version = graph->version;
+    return 0;
+}
+
+int treeCacheRegister(TreeCache* cache, const Graph* graph, int origin) {
+    if (!graph->finalized || origin < 0 || origin >= graph->nodeCount) return -1;
+    for (int i = 0; i < cache->count; i++) {
+        if (cache->trees[i].origin == origin) return 0;
+    }
+    if (cache->version != graph->version && refreshTrees(cache, graph) != 0) return -1;
+    if (reserveNodes(cache, graph->nodeCount) != 0) return -1;
+    if (cache->count == cache->capacity) {
+        int capacity = cache->capacity ? cache->capacity * 2 : 4;
+        CachedTree* trees = (CachedTree*)realloc(cache->trees, capacity * sizeof(CachedTree));
+        if (trees == NULL) return -1;
+        cache->trees = trees;
+        cache->capacity = capacity;
+    }
+    CachedTree* tree = &cache->trees[cache->count];
+    tree->origin = origin;
+    tree->distance = (int*)malloc(cache->nodeCount * sizeof(int));
+    tree->previous = (int*)malloc(cache->nodeCount * sizeof(int));
+    if (tree->distance == NULL || tree->previous == NULL || computeTree(cache, graph, tree) != 0) {
+        free(tree->distance);
+        free(tree->previous);
+        return -1;
+    }
+    cache->count++;
+    cache->version = graph->version;
+    return 0;
+}
+
+const CachedTree* treeCacheFind(TreeCache* cache, const Graph* graph, int origin) {
+    for (int i = 0; i < cache->count; i++) {
+        if (cache->trees[i].origin != origin) continue;
+        if (cache->version != graph->version && refreshTrees(cache, graph) != 0) return NULL;
+        return &cache->trees[i];
+    }
+    return NULL;
+}
+
+// Current travel time of the road between two nodes. A batch may name the same road more
+// than once, so the repair reads the weight that was applied last from the graph.
+static int roadWeight(const Graph* graph, int from, int to) {
+    int weight = UNREACHABLE;
+    for (int e = graph->offsets[from]; e < graph->offsets[from + 1]; e++) {
+        if (graph->targets[e] == to && graph->weights[e] < weight) weight = graph->weights[e];
+    }
+    return weight;
+}
+
+// Bring one tree up to date after the roads in updates changed weight.
+//  1. A road on the tree that got slower invalidates the whole subtree below it: those
+//     nodes are cut off and re-seeded from their best neighbor outside the cut.
+//  2. A road that got faster and now beats the tree seeds its far end.
+//  3. Dijkstra from the seeds spreads the changes and stops where distances hold.
+static int repairTree(TreeCache* cache, const Graph* graph, CachedTree* tree, const RoadUpdate* updates, int count) {
+    int* distance = tree->distance;
+    int* previous = tree->previous;
+    if (++cache->stamp == 0) {
+        memset(cache->mark, 0, cache->nodeCount * sizeof(unsigned int));
+        cache->stamp = 1;
+    }
+    pqClear(&cache->queue);
+
+    int cut = 0;
+    for (int i = 0; i < count; i++) {
+        for (int side = 0; side < 2; side++) {
+            int parent = side ? updates[i].to : updates[i].from;
+            int child = side ? updates[i].from : updates[i].to;
+            if (previous[child] != parent || cache->mark[child] == cache->stamp) continue;
+            if (distance[parent] + roadWeight(graph, parent, child) <= distance[child]) continue;
+            cache->mark[child] = cache->stamp;
+            cache->stack[cut++] = child;
+        }
+    }
+    // The cut-off region is every descendant of the roots, found through previous[]
+    for (int i = 0; i < cut; i++) {
+        int node = cache->stack[i];
+        for (int e = graph->offsets[node]; e < graph->offsets[node + 1]; e++) {
+            int next = graph->targets[e];
+            if (previous[next] == node && cache->mark[next] != cache->stamp) {
+                cache->mark[next] = cache->stamp;
+                cache->stack[cut++] = next;
+            }
+        }
+    }
+    for (int i = 0; i < cut; i++) {
+        distance[cache->stack[i]] = UNREACHABLE;
+        previous[cache->stack[i]] = -1;
+    }
+    for (int i = 0; i < cut; i++) {
+        int node = cache->stack[i];
+        for (int e = graph->offsets[node]; e < graph->offsets[node + 1]; e++) {
+            int next = graph->targets[e];
+            if (cache->mark[next] == cache->stamp || distance[next] == UNREACHABLE) continue;
+            int candidate = distance[next] + graph->weights[e];
+            if (candidate < distance[node]) {
+                distance[node] = candidate;
+                previous[node] = next;
+            }
+        }
+        if (distance[node] != UNREACHABLE && pqPush(&cache->queue, node, distance[node]) != 0) return -1;
+    }
+
+    for (int i = 0; i < count; i++) {
+        for (int side = 0; side < 2; side++) {
+            int from = side ? updates[i].to : updates[i].from;
+            int to = side ? updates[i].from : updates[i].to;
+            if (distance[from] == UNREACHABLE) continue;
+            int candidate = distance[from] + roadWeight(graph, from, to);
+            if (candidate >= distance[to]) continue;
+            distance[to] = candidate;
+            previous[to] = from;
+            if (pqPush(&cache->queue, to, distance[to]) != 0) return -1;
+        }
+    }
+
+    cache->touched += cut;
+    int key;
+    int node;
+    while ((node = pqPop(&cache->queue, &key)) != -1) {
+        cache->touched++;
+        for (int e = graph->offsets[node]; e < graph->offsets[node + 1]; e++) {
+            int next = graph->targets[e];
+            int candidate = key + graph->weights[e];
+            if (candidate < distance[next]) {
+                distance[next] = candidate;
+                previous[next] = node;
+                if (pqPush(&cache->queue, next, candidate) != 0) return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+int treeCacheApply(TreeCache* cache, Graph* graph, const RoadUpdate* updates, int count) {
+    int stale = cache->version != graph->version;
+    if (updateRoadWeights(graph, updates, count) != 0) return -1;
+    cache->touched = 0;
+    if (stale) return refreshTrees(cache, graph); // Trees missed earlier changes: start over
+    for (int i = 0; i < cache->count; i++) {
+        if (repairTree(cache, graph, &cache->trees[i], updates, count) != 0) {
+            cache->version = 0; // Half-repaired trees: recompute on the next lookup
+            return -1;
+        }
+    }
+    cache->version = graph->version;
+    return 0;
+}
+
+void treeRoute(TreeCache* cache, const Graph* graph, const char* startNode, const char* endNode) {
+    int startIndex = findNode(graph, startNode);
+    int endIndex = findNode(graph, endNode);
+    if (startIndex == -1 || endIndex == -1) {
+        printf("Invalid start or end node.\n");
+        return;
+    }
+    const CachedTree* tree = treeCacheFind(cache, graph, startIndex);
+    if (tree == NULL) {
+        printf("No cached tree for %s.\n", startNode);
+    } else if (tree->distance[endIndex] == UNREACHABLE) {
+        printf("No path found from %s to %s.\n", startNode, endNode);
+    } else {
+        printf("Shortest path from %s to %s:\n", startNode, endNode);
+        for (int at = endIndex; at != -1; at = tree->previous[at]) {
+            printf("%s ", graph->nodes[at].name);
+        }
+        printf("\nTotal travel time: %d\n", tree->distance[endIndex]);
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef TREES_H
+#define TREES_H
+
+#include "graph.h"
+#include "search.h"
+
+// Shortest-path tree of one registered origin: travel time and predecessor of every node
+typedef struct {
+    int origin;
+    int* distance;       // UNREACHABLE where there is no route
+    int* previous;       // -1 at the origin and at unreachable nodes
+} CachedTree;
+
+// Shortest-path trees kept current for frequently used origins (dispatch centers).
+// Travel-time changes applied through treeCacheApply repair every tree in place,
+// touching only the nodes whose distances can change.
+typedef struct {
+    CachedTree* trees;
+    int count;
+    int capacity;
+    int nodeCount;       // Size of each tree's arrays
+    unsigned int version; // Graph version the trees match
+    SearchState search;  // Full searches on registration or refresh
+    PriorityQueue queue; // Repair frontier
+    unsigned int* mark;  // Nodes cut off by the current repair carry the current stamp
+    unsigned int stamp;
+    int* stack;          // Subtree walk
+    int touched;         // Nodes relabeled by the last repair, all trees
+} TreeCache;
+
+int treeCacheInit(TreeCache* cache);
+void treeCacheFree(TreeCache* cache);
+
+// Compute and keep the tree of origin; registering an origin twice is a no-op
+int treeCacheRegister(TreeCache* cache, const Graph* graph, int origin);
+
+// Tree of a registered origin, up to date with the graph. Trees are recomputed from
+// scratch if the graph changed other than through treeCacheApply (e.g. new roads).
+// Returns NULL if origin is not registered or memory runs out.
+const CachedTree* treeCacheFind(TreeCache* cache, const Graph* graph, int origin);
+
+// Apply a batch of travel-time updates to the graph and repair every cached tree.
+// Returns 0, or -1 if the batch is invalid (nothing changes) or memory runs out.
+int treeCacheApply(TreeCache* cache, Graph* graph, const RoadUpdate* updates, int count);
+
+// Print the route from a registered origin like dijkstra does, read from its cached tree
+void treeRoute(TreeCache* cache, const Graph* graph, const char* startNode, const char* endNode);
+
+#endif // TREES_H
@@ -1,177 +1,314 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <limits.h>
 
 #define MAX_CHAR 256
-#define MAX_TREE_HEIGHT 100
-
-// Node structure for Huffman tree
-struct Node {
-    char character;
-    unsigned frequency;
-    struct Node *left, *right;
+#define MAX_CODE_LENGTH 15    // Longest code package-merge may assign, 8 to MAX_STORED_LENGTH
+#define MAX_STORED_LENGTH 15  // Longest code length the header's four-bit fields hold
+#define HEADER_SIZE (8 + MAX_CHAR / 2) // Original size, then two code lengths per byte
+#define DECODE_TABLE_BITS 11  // Code bits the first-level decode table resolves in one lookup
+
+#if MAX_CODE_LENGTH < 8 || MAX_CODE_LENGTH > MAX_STORED_LENGTH
+#error "MAX_CODE_LENGTH must leave room for 256 symbols and fit the header"
+#endif
+
+// Huffman code of a symbol as an integer: the low length bits of bits, first bit most significant
+struct HuffmanCode {
+    uint64_t bits;
+    int length;
 };
 
-// Min-heap structure
-struct MinHeap {
-    unsigned size;
-    unsigned capacity;
-    struct Node** array;
+// Global table of Huffman codes
+struct HuffmanCode huffmanCodes[MAX_CHAR];
+
+// Package-merge list item: a symbol, or a package of two neighboring items from the
+// list for the next longer code length
+struct MergeItem {
+    uint64_t weight;
+    int symbol;     // -1 for a package
 };
 
-// Function to create a new node
-struct Node* newNode(char character, unsigned frequency) {
-    struct Node* temp = (struct Node*)malloc(sizeof(struct Node));
-    temp->left = temp->right = NULL;
-    temp->character = character;
-    temp->frequency = frequency;
-    return temp;
+int compareMergeItems(const void* a, const void* b) {
+    const struct MergeItem* x = (const struct MergeItem*)a;
+    const struct MergeItem* y = (const struct MergeItem*)b;
+    if (x->weight != y->weight) return x->weight < y->weight ? -1 : 1;
+    return x->symbol - y->symbol;
 }
 
-// Function to create a MinHeap
-struct MinHeap* createMinHeap(unsigned capacity) {
-    struct MinHeap* minHeap = (struct MinHeap*)malloc(sizeof(struct MinHeap));
-    minHeap->size = 0;
-    minHeap->capacity = capacity;
-    minHeap->array = (struct Node**)malloc(minHeap->capacity * sizeof(struct Node*));
-    return minHeap;
-}
+// Function to compute optimal code lengths of at most MAX_CODE_LENGTH bits by
+// package-merge. List 0 holds the symbols by frequency; every longer list adds packages
+// of pairs from the one before. The cheapest 2n - 2 items of the last list give one bit
+// to each symbol they contain, and a package takes its pair from the list before. A lone
+// symbol gets a 1-bit code. Returns 0, or -1 if out of memory.
+int computeCodeLengths(const int freq[MAX_CHAR], unsigned char lengths[MAX_CHAR]) {
+    struct MergeItem symbols[MAX_CHAR];
+    int n = 0;
+    memset(lengths, 0, MAX_CHAR);
+    for (int i = 0; i < MAX_CHAR; i++) {
+        if (freq[i] > 0) {
+            symbols[n].weight = (uint64_t)freq[i];
+            symbols[n].symbol = i;
+            n++;
+        }
+    }
+    if (n < 2) {
+        if (n == 1) lengths[symbols[0].symbol] = 1;
+        return 0;
+    }
+    qsort(symbols, n, sizeof(struct MergeItem), compareMergeItems);
+
+    // A list holds the n symbols and at most n - 1 packages
+    int capacity = 2 * n;
+    int sizes[MAX_CODE_LENGTH];
+    struct MergeItem* lists = (struct MergeItem*)malloc((size_t)MAX_CODE_LENGTH * capacity * sizeof(struct MergeItem));
+    if (!lists) return -1;
+    memcpy(lists, symbols, n * sizeof(struct MergeItem));
+    sizes[0] = n;
+    for (int level = 1; level < MAX_CODE_LENGTH; level++) {
+        const struct MergeItem* previous = lists + (size_t)(level - 1) * capacity;
+        struct MergeItem* list = lists + (size_t)level * capacity;
+        int packages = sizes[level - 1] / 2;
+        int symbol = 0, package = 0, size = 0;
+        while (symbol < n || package < packages) {
+            uint64_t packageWeight = package < packages
+                ? previous[2 * package].weight + previous[2 * package + 1].weight : UINT64_MAX;
+            if (symbol < n && symbols[symbol].weight <= packageWeight) {
+                list[size++] = symbols[symbol++];
+            } else {
+                list[size].weight = packageWeight;
+                list[size].symbol = -1;
+                size++;
+                package++;
+            }
+        }
+        sizes[level] = size;
+    }
 
-// Function to swap two min heap nodes
-void swapNode(struct Node** a, struct Node** b) {
-    struct Node* t = *a;
-    *a = *b;
-    *b = t;
+    int take = 2 * n - 2;
+    for (int level = MAX_CODE_LENGTH - 1; level >= 0 && take > 0; level--) {
+        const struct MergeItem* list = lists + (size_t)level * capacity;
+        int packages = 0;
+        for (int i = 0; i < take; i++) {
+            if (list[i].symbol >= 0) lengths[list[i].symbol]++;
+            else packages++;
+        }
+        take = 2 * packages;
+    }
+    free(lists);
+    return 0;
 }
 
-// Heapify function
-void minHeapify(struct MinHeap* minHeap, int idx) {
-    int smallest = idx;
-    int left = 2 * idx + 1;
-    int right = 2 * idx + 2;
+// Function to assign canonical codes: shorter codes first, and codes of one length
+// consecutive in symbol order, so the lengths alone determine every code
+void assignCanonicalCodes(const unsigned char lengths[MAX_CHAR], struct HuffmanCode codes[MAX_CHAR]) {
+    int lengthCount[MAX_STORED_LENGTH + 1] = {0};
+    uint64_t nextCode[MAX_STORED_LENGTH + 1];
+    for (int i = 0; i < MAX_CHAR; i++) {
+        lengthCount[lengths[i]]++;
+    }
+    lengthCount[0] = 0;
+    uint64_t code = 0;
+    for (int length = 1; length <= MAX_STORED_LENGTH; length++) {
+        code = (code + lengthCount[length - 1]) << 1;
+        nextCode[length] = code;
+    }
+    for (int i = 0; i < MAX_CHAR; i++) {
+        codes[i].length = lengths[i];
+        codes[i].bits = lengths[i] ? nextCode[lengths[i]]++ : 0;
+    }
+}
 
-    if (left < (int)minHeap->size && minHeap->array[left]->frequency < minHeap->array[smallest]->frequency)
-        smallest = left;
+// Header: the original size as 8 bytes little-endian, then the code length of every
+// symbol in four bits, symbol 2i in the high half of byte i and 0 for unused symbols
+void packHeader(unsigned char header[HEADER_SIZE], long size, const unsigned char lengths[MAX_CHAR]) {
+    for (int i = 0; i < 8; i++) {
+        header[i] = (unsigned char)((uint64_t)size >> (8 * i));
+    }
+    for (int i = 0; i < MAX_CHAR / 2; i++) {
+        header[8 + i] = (unsigned char)((lengths[2 * i] << 4) | lengths[2 * i + 1]);
+    }
+}
 
-    if (right < (int)minHeap->size && minHeap->array[right]->frequency < minHeap->array[smallest]->frequency)
-        smallest = right;
+// Read a header back; returns the number of symbols it codes, or -1 if the header does
+// not describe a complete prefix code (a lone symbol may have any length)
+int unpackHeader(const unsigned char header[HEADER_SIZE], long* size, unsigned char lengths[MAX_CHAR]) {
+    uint64_t value = 0;
+    for (int i = 0; i < 8; i++) {
+        value |= (uint64_t)header[i] << (8 * i);
+    }
+    if (value > (uint64_t)LONG_MAX) return -1;
+    *size = (long)value;
 
-    if (smallest != idx) {
-        swapNode(&minHeap->array[smallest], &minHeap->array[idx]);
-        minHeapify(minHeap, smallest);
+    int symbolCount = 0;
+    uint32_t kraftSum = 0; // Sum of 2^-length, in units of 2^-MAX_STORED_LENGTH
+    for (int i = 0; i < MAX_CHAR; i++) {
+        lengths[i] = (i & 1) ? header[8 + i / 2] & 0x0F : header[8 + i / 2] >> 4;
+        if (lengths[i]) {
+            symbolCount++;
+            kraftSum += 1u << (MAX_STORED_LENGTH - lengths[i]);
+        }
     }
+    if (symbolCount == 0) return *size == 0 ? 0 : -1;
+    if (symbolCount > 1 && kraftSum != 1u << MAX_STORED_LENGTH) return -1;
+    return symbolCount;
 }
 
-// Function to check if size of heap is 1
-int isSizeOne(struct MinHeap* minHeap) {
-    return (minHeap->size == 1);
-}
+// 64-bit bit accumulator writing into a memory buffer. Pending bits sit at the top of
+// bits, and count (0 to 7 between codes) says how many.
+struct BitWriter {
+    unsigned char* next;
+    uint64_t bits;
+    int count;
+};
 
-// Function to extract minimum value node from heap
-struct Node* extractMin(struct MinHeap* minHeap) {
-    struct Node* temp = minHeap->array[0];
-    minHeap->array[0] = minHeap->array[minHeap->size - 1];
-    --minHeap->size;
-    minHeapify(minHeap, 0);
-    return temp;
+static inline void storeBigEndian64(unsigned char* p, uint64_t value) {
+    p[0] = (unsigned char)(value >> 56);
+    p[1] = (unsigned char)(value >> 48);
+    p[2] = (unsigned char)(value >> 40);
+    p[3] = (unsigned char)(value >> 32);
+    p[4] = (unsigned char)(value >> 24);
+    p[5] = (unsigned char)(value >> 16);
+    p[6] = (unsigned char)(value >> 8);
+    p[7] = (unsigned char)value;
 }
 
-// Function to insert a new node to MinHeap
-void insertMinHeap(struct MinHeap* minHeap, struct Node* minHeapNode) {
-    ++minHeap->size;
-    int i = minHeap->size - 1;
-
-    while (i && minHeapNode->frequency < minHeap->array[(i - 1) / 2]->frequency) {
-        minHeap->array[i] = minHeap->array[(i - 1) / 2];
-        i = (i - 1) / 2;
-    }
-    minHeap->array[i] = minHeapNode;
+// Append a code of up to MAX_CODE_LENGTH bits without branching: all eight accumulator
+// bytes are stored, and next advances over the complete ones. The buffer needs eight
+// bytes of slack past the payload.
+static inline void writeCode(struct BitWriter* writer, struct HuffmanCode code) {
+    writer->bits |= code.bits << (64 - writer->count - code.length);
+    writer->count += code.length;
+    storeBigEndian64(writer->next, writer->bits);
+    writer->next += writer->count >> 3;
+    writer->bits <<= writer->count & ~7;
+    writer->count &= 7;
 }
 
-// Function to build Huffman tree
-struct Node* buildHuffmanTree(char data[], int freq[], int size) {
-    struct Node *left, *right, *top;
-    struct MinHeap* minHeap = createMinHeap(size);
+// Decode table entry: a symbol with the code bits it takes, or a link to a second-level
+// table for codes longer than the first level resolves
+struct DecodeEntry {
+    unsigned short value;    // Symbol, or first entry of the linked table
+    unsigned char length;    // Bits consumed at this level
+    unsigned char subBits;   // Index bits of the linked table, 0 for a symbol
+};
 
-    for (int i = 0; i < size; ++i)
-        insertMinHeap(minHeap, newNode(data[i], freq[i]));
+// The first-level table (1 << rootBits entries) followed by every linked table
+struct DecodeTable {
+    struct DecodeEntry* entries;
+    int rootBits;
+};
 
-    while (!isSizeOne(minHeap)) {
-        left = extractMin(minHeap);
-        right = extractMin(minHeap);
-        top = newNode('$', left->frequency + right->frequency);
-        top->left = left;
-        top->right = right;
-        insertMinHeap(minHeap, top);
+// Build the decode tables for a complete code of at least two symbols straight from the
+// code lengths. A code of up to rootBits bits fills every first-level entry it prefixes.
+// Longer codes sharing a first-level prefix get one linked table, indexed by the bits
+// after the prefix, as many as the longest of them needs. Returns 0, or -1 if out of memory.
+int buildDecodeTable(struct DecodeTable* table, const unsigned char lengths[MAX_CHAR]) {
+    struct HuffmanCode codes[MAX_CHAR];
+    assignCanonicalCodes(lengths, codes);
+    int maxLength = 0;
+    for (int i = 0; i < MAX_CHAR; i++) {
+        if (lengths[i] > maxLength) maxLength = lengths[i];
     }
+    int rootBits = maxLength < DECODE_TABLE_BITS ? maxLength : DECODE_TABLE_BITS;
+    table->rootBits = rootBits;
 
-    return extractMin(minHeap);
-}
-
-// Global variables for Huffman codes
-char huffmanCodes[MAX_CHAR][MAX_TREE_HEIGHT];
-int codeLengths[MAX_CHAR];
-
-// Function to store Huffman codes
-void storeCodes(struct Node* root, int arr[], int top) {
-    if (root->left) {
-        arr[top] = 0;
-        storeCodes(root->left, arr, top + 1);
+    // Size the linked table behind each first-level entry
+    unsigned char subBits[1 << DECODE_TABLE_BITS] = {0};
+    for (int i = 0; i < MAX_CHAR; i++) {
+        int extra = codes[i].length - rootBits;
+        if (extra > 0) {
+            int prefix = (int)(codes[i].bits >> extra);
+            if (extra > subBits[prefix]) subBits[prefix] = (unsigned char)extra;
+        }
     }
-    if (root->right) {
-        arr[top] = 1;
-        storeCodes(root->right, arr, top + 1);
+    int count = 1 << rootBits;
+    for (int prefix = 0; prefix < (1 << rootBits); prefix++) {
+        if (subBits[prefix]) count += 1 << subBits[prefix];
     }
-    if (!(root->left) && !(root->right)) {
-        for (int i = 0; i < top; i++) {
-            huffmanCodes[(unsigned char)root->character][i] = arr[i] + '0';
+    table->entries = (struct DecodeEntry*)malloc(count * sizeof(struct DecodeEntry));
+    if (!table->entries) return -1;
+
+    int next = 1 << rootBits;
+    for (int prefix = 0; prefix < (1 << rootBits); prefix++) {
+        if (subBits[prefix]) {
+            struct DecodeEntry link = { (unsigned short)next, (unsigned char)rootBits, subBits[prefix] };
+            table->entries[prefix] = link;
+            next += 1 << subBits[prefix];
         }
-        huffmanCodes[(unsigned char)root->character][top] = '\0';
-        codeLengths[(unsigned char)root->character] = top;
     }
+    for (int i = 0; i < MAX_CHAR; i++) {
+        int length = codes[i].length;
+        if (length == 0) continue;
+        struct DecodeEntry* first;
+        int spare;
+        struct DecodeEntry entry = { (unsigned short)i, (unsigned char)length, 0 };
+        if (length <= rootBits) {
+            spare = rootBits - length;
+            first = &table->entries[codes[i].bits << spare];
+        } else {
+            int extra = length - rootBits;
+            struct DecodeEntry link = table->entries[codes[i].bits >> extra];
+            spare = link.subBits - extra;
+            first = &table->entries[link.value + ((codes[i].bits & ((1u << extra) - 1)) << spare)];
+            entry.length = (unsigned char)extra;
+        }
+        for (int j = 0; j < (1 << spare); j++) {
+            first[j] = entry;
+        }
+    }
+    return 0;
 }
 
-// Advanced bit buffer for efficient compression
-struct BitBuffer {
-    unsigned char buffer;
-    int bitCount;
-    FILE* file;
+// 64-bit bit reservoir over an in-memory payload. The next unread bit is the top bit
+// of bits; count bits are valid and the bits below them are either zero or the bits
+// that follow in the payload.
+struct BitReader {
+    const unsigned char* next;
+    const unsigned char* end;
+    uint64_t bits;
+    int count;
 };
 
-void initBitBuffer(struct BitBuffer* bb, FILE* file) {
-    bb->buffer = 0;
-    bb->bitCount = 0;
-    bb->file = file;
+static inline uint64_t loadBigEndian64(const unsigned char* p) {
+    return ((uint64_t)p[0] << 56) | ((uint64_t)p[1] << 48) | ((uint64_t)p[2] << 40) | ((uint64_t)p[3] << 32) |
+           ((uint64_t)p[4] << 24) | ((uint64_t)p[5] << 16) | ((uint64_t)p[6] << 8) | (uint64_t)p[7];
 }
 
-void writeBit(struct BitBuffer* bb, int bit) {
-    bb->buffer |= (bit << (7 - bb->bitCount));
-    bb->bitCount++;
-    
-    if (bb->bitCount == 8) {
-        fputc(bb->buffer, bb->file);
-        bb->buffer = 0;
-        bb->bitCount = 0;
-    }
-}
-
-void flushBits(struct BitBuffer* bb) {
-    if (bb->bitCount > 0) {
-        fputc(bb->buffer, bb->file);
+// Top the reservoir up to at least 56 bits, or to the end of the payload. The fast path
+// loads eight bytes at once and keeps only the whole bytes that fit; the part of the next
+// byte it also shifts in is loaded again, at the same position, by the next refill.
+static inline void refillBits(struct BitReader* reader) {
+    if (reader->end - reader->next >= 8) {
+        reader->bits |= loadBigEndian64(reader->next) >> reader->count;
+        reader->next += (63 - reader->count) >> 3;
+        reader->count |= 56;
+    } else {
+        while (reader->count <= 56 && reader->next < reader->end) {
+            reader->bits |= (uint64_t)*reader->next++ << (56 - reader->count);
+            reader->count += 8;
+        }
     }
 }
 
-int readBit(struct BitBuffer* bb) {
-    if (bb->bitCount == 0) {
-        int byte = fgetc(bb->file);
-        if (byte == EOF) return -1;
-        bb->buffer = (unsigned char)byte;
-        bb->bitCount = 8;
+// Decode one symbol: a single lookup on the top bits of the reservoir, which must hold
+// at least the first-level table's bits; only longer codes follow a link. Returns the
+// symbol, or -1 if the payload ends inside a code. Forced inline so the reservoir
+// stays in registers across the decode loop.
+static inline __attribute__((always_inline)) int decodeSymbol(const struct DecodeTable* table, struct BitReader* reader) {
+    struct DecodeEntry entry = table->entries[reader->bits >> (64 - table->rootBits)];
+    if (entry.subBits) {
+        if (entry.length > reader->count) return -1;
+        reader->bits <<= entry.length;
+        reader->count -= entry.length;
+        refillBits(reader);
+        entry = table->entries[entry.value + (reader->bits >> (64 - entry.subBits))];
     }
-    
-    int bit = (bb->buffer >> (bb->bitCount - 1)) & 1;
-    bb->bitCount--;
-    return bit;
+    if (entry.length > reader->count) return -1;
+    reader->bits <<= entry.length;
+    reader->count -= entry.length;
+    return entry.value;
 }
 
 // Function to compress file with advanced bit-level compression
@@ -204,54 +341,58 @@ void compressFile(char *filename) {
         freq[(unsigned char)data[i]]++;
     }
 
-    // Build Huffman tree
-    char uniqueChars[MAX_CHAR];
-    int uniqueFreq[MAX_CHAR];
+    // Derive length-limited code lengths and their canonical codes, and size the payload
+    unsigned char lengths[MAX_CHAR];
+    if (computeCodeLengths(freq, lengths) != 0) {
+        perror("Memory allocation failed");
+        free(data);
+        return;
+    }
+    assignCanonicalCodes(lengths, huffmanCodes);
     int uniqueCount = 0;
-    
+    uint64_t payloadBits = 0;
     for (int i = 0; i < MAX_CHAR; i++) {
-        if (freq[i] > 0) {
-            uniqueChars[uniqueCount] = (char)i;
-            uniqueFreq[uniqueCount] = freq[i];
+        if (lengths[i]) {
             uniqueCount++;
+            payloadBits += (uint64_t)freq[i] * lengths[i];
+        }
+    }
+    if (uniqueCount < 2) payloadBits = 0;
+    size_t payloadBytes = (size_t)((payloadBits + 7) / 8);
+    unsigned char *payload = (unsigned char*)malloc(payloadBytes + 8);
+    if (!payload) {
+        perror("Memory allocation failed");
+        free(data);
+        return;
+    }
+
+    // Encode into memory: one table load and a few shifts per byte. A lone symbol needs
+    // no payload, since its count is the original size.
+    struct BitWriter writer = { payload, 0, 0 };
+    if (uniqueCount > 1) {
+        for (long i = 0; i < fileSize; i++) {
+            writeCode(&writer, huffmanCodes[(unsigned char)data[i]]);
         }
     }
-    
-    struct Node* root = buildHuffmanTree(uniqueChars, uniqueFreq, uniqueCount);
-    
-    // Store Huffman codes
-    int arr[MAX_TREE_HEIGHT];
-    storeCodes(root, arr, 0);
 
     // Write compressed file
     FILE *output = fopen("compressed.txt", "wb");
     if (!output) {
         perror("Output file opening failed");
+        free(payload);
         free(data);
         return;
     }
 
-    // Write header with character frequencies (binary format)
-    fwrite(&fileSize, sizeof(long), 1, output);
-    fwrite(&uniqueCount, sizeof(int), 1, output);
-    for (int i = 0; i < uniqueCount; i++) {
-        fwrite(&uniqueChars[i], sizeof(char), 1, output);
-        fwrite(&uniqueFreq[i], sizeof(int), 1, output);
-    }
+    // Write header with the original size and code lengths (binary format)
+    unsigned char header[HEADER_SIZE];
+    packHeader(header, fileSize, lengths);
+    fwrite(header, 1, HEADER_SIZE, output);
 
-    // Write compressed data using bit buffer
-    struct BitBuffer bb;
-    initBitBuffer(&bb, output);
-    
-    for (long i = 0; i < fileSize; i++) {
-        char* code = huffmanCodes[(unsigned char)data[i]];
-        for (int j = 0; code[j]; j++) {
-            writeBit(&bb, code[j] - '0');
-        }
-    }
-    
-    flushBits(&bb);
+    // Write compressed data; a partial last byte is already stored, zero-padded
+    fwrite(payload, 1, payloadBytes, output);
     fclose(output);
+    free(payload);
     free(data);
 
     printf("Original Size: %ld bytes\n", fileSize);
@@ -267,54 +408,95 @@ void decompressFile(char *filename) {
     }
 
     // Read header
+    unsigned char header[HEADER_SIZE];
+    unsigned char lengths[MAX_CHAR];
     long originalSize;
-    fread(&originalSize, sizeof(long), 1, file);
-    int uniqueCount;
-    fread(&uniqueCount, sizeof(int), 1, file);
-    
-    char data[MAX_CHAR];
-    int freqArray[MAX_CHAR];
-    
-    for (int i = 0; i < uniqueCount; i++) {
-        fread(&data[i], sizeof(char), 1, file);
-        fread(&freqArray[i], sizeof(int), 1, file);
+    int uniqueCount = -1;
+    if (fread(header, 1, HEADER_SIZE, file) == HEADER_SIZE) {
+        uniqueCount = unpackHeader(header, &originalSize, lengths);
     }
-    
-    // Build Huffman tree
-    struct Node* root = buildHuffmanTree(data, freqArray, uniqueCount);
-    
-    // Decode compressed data
-    FILE *output = fopen("decompressed.txt", "w");
-    if (!output) {
-        perror("Output file opening failed");
+    if (uniqueCount < 0) {
+        fprintf(stderr, "Invalid compressed header\n");
         fclose(file);
         return;
     }
-    
-    struct BitBuffer bb;
-    bb.file = file;
-    bb.bitCount = 0;
-    
-    struct Node* current = root;
-    int bit;
-    int decodedChars = 0;
-    
-    while (decodedChars < originalSize && (bit = readBit(&bb)) != -1) {
-        if (bit == 0) {
-            current = current->left;
-        } else {
-            current = current->right;
+
+    // The rest of the file is the payload; decode it from memory
+    long payloadStart = ftell(file);
+    fseek(file, 0, SEEK_END);
+    long payloadSize = ftell(file) - payloadStart;
+    fseek(file, payloadStart, SEEK_SET);
+    unsigned char *payload = (unsigned char*)malloc(payloadSize > 0 ? payloadSize : 1);
+    unsigned char *decoded = (unsigned char*)malloc(originalSize > 0 ? originalSize : 1);
+    if (!payload || !decoded || (long)fread(payload, 1, payloadSize, file) != payloadSize) {
+        perror("Reading compressed data failed");
+        free(payload);
+        free(decoded);
+        fclose(file);
+        return;
+    }
+    fclose(file);
+
+    long decodedChars = 0;
+    if (uniqueCount == 1) {
+        // A lone symbol has no payload
+        int symbol = 0;
+        while (!lengths[symbol]) symbol++;
+        memset(decoded, symbol, originalSize);
+        decodedChars = originalSize;
+    } else if (uniqueCount > 1) {
+        // Build the decode tables from the code lengths
+        struct DecodeTable table;
+        if (buildDecodeTable(&table, lengths) != 0) {
+            perror("Memory allocation failed");
+            free(payload);
+            free(decoded);
+            return;
         }
-        
-        if (!current->left && !current->right) {
-            fputc(current->character, output);
-            decodedChars++;
-            current = root;
+
+        // One refill holds at least 56 bits, enough for four first-level codes, so the
+        // main loop refills without branching once per four symbols
+        struct BitReader reader = { payload, payload + payloadSize, 0, 0 };
+        int truncated = 0;
+        while (originalSize - decodedChars >= 4 && reader.end - reader.next >= 8) {
+            refillBits(&reader);
+            int first = decodeSymbol(&table, &reader);
+            int second = decodeSymbol(&table, &reader);
+            int third = decodeSymbol(&table, &reader);
+            int fourth = decodeSymbol(&table, &reader);
+            if ((first | second | third | fourth) < 0) {
+                truncated = 1;
+                break;
+            }
+            decoded[decodedChars] = (unsigned char)first;
+            decoded[decodedChars + 1] = (unsigned char)second;
+            decoded[decodedChars + 2] = (unsigned char)third;
+            decoded[decodedChars + 3] = (unsigned char)fourth;
+            decodedChars += 4;
+        }
+        while (!truncated && decodedChars < originalSize) {
+            refillBits(&reader);
+            int symbol = decodeSymbol(&table, &reader);
+            if (symbol < 0) break; // Payload ran out
+            decoded[decodedChars++] = (unsigned char)symbol;
         }
+        free(table.entries);
     }
-    
-    fclose(file);
+
+    FILE *output = fopen("decompressed.txt", "w");
+    if (!output) {
+        perror("Output file opening failed");
+        free(payload);
+        free(decoded);
+        return;
+    }
+    fwrite(decoded, 1, decodedChars, output);
     fclose(output);
+    free(payload);
+    free(decoded);
+    if (decodedChars < originalSize) {
+        fprintf(stderr, "Compressed data ended after %ld of %ld characters\n", decodedChars, originalSize);
+    }
     printf("Decompressed file created successfully.\n");
 }
 